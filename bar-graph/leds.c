@@ -3,6 +3,7 @@ Playing around with a bunch of LEDs directly driven off a ATMega168.
 */
 
 
+#include <avr/interrupt.h>
 #include <avr/io.h>
 #include <math.h>
 #include <stdlib.h>
@@ -52,15 +53,151 @@ led_pin leds[num_leds] = {
 };
 
 
+/**
+Software PWM for every LED, using bit-angle modulation (BAM).
+
+Each LED's brightness is split into its bits. Bit n is shown for 2^n time
+units, so a frame of BAM_BITS 'bit-planes' lasts 2^BAM_BITS - 1 units, and the
+LED is on for exactly as many units as its brightness.
+
+Rather than comparing every channel against a counter, each plane is kept as
+one precomputed mask per port. The timer1 ISR only fires once per plane, and
+writes each port once, however many LEDs are lit. The cost of a channel is
+paid in `led_brightness()` instead, which updates BAM_BITS bytes.
+
+Timer1 counts CPU cycles in CTC mode, with OCR1A doubled for each plane. The
+shortest plane, BAM_UNIT cycles, must outlast the ISR, or the next compare
+match is missed and the display glitches until timer1 wraps. ISR and update
+costs are hand-estimated for -Os:
+
+    ====================  ========  ============================================
+    Engine                ISR       Interrupts per frame
+    ====================  ========  ============================================
+    BAM, any channels     ~70       BAM_BITS
+    Counter PWM [1]       ~30 + 8N  2^BAM_BITS
+    ====================  ========  ============================================
+
+Setting one LED with `led_brightness()` takes about 20 + 10 * BAM_BITS cycles.
+
+    ======  ====  =========  ========  ========  ==============================
+    Clock   Bits  BAM_UNIT   Frame     CPU load  Note
+    ======  ====  =========  ========  ========  ==============================
+    1MHz    6     128        124Hz     5.2%      Default
+    1MHz    8     128        31Hz      1.7%      Flickers
+    8MHz    8     128        245Hz     1.7%
+    8MHz    8     512        61Hz      0.4%
+    ======  ====  =========  ========  ========  ==============================
+
+[1] One interrupt per brightness step, comparing each of N channels: about
+    140% load for 18 LEDs at 124Hz and 6 bits on a 1MHz CPU. It can't be done.
+*/
+
+#ifndef BAM_BITS
+#define BAM_BITS    6
+#endif
+
+#ifndef BAM_UNIT
+#define BAM_UNIT    128         /** Cycles in shortest plane, more than ISR */
+#endif
+
+#if BAM_BITS < 1 || BAM_BITS > 8
+#error "BAM_BITS must be 1 to 8, the bits of a brightness level"
+#endif
+
+#if (BAM_UNIT << (BAM_BITS - 1)) - 1 > 0xffff
+#error "Longest plane must fit 16-bit OCR1A: reduce BAM_UNIT or BAM_BITS"
+#endif
+
+#define BAM_PORTS   3           /** PORTB, PORTC, and PORTD */
+
+volatile uint8_t bam_planes[BAM_BITS][BAM_PORTS];
+uint8_t bam_keep[BAM_PORTS] = {0xff, 0xff, 0xff};
+
+
+/**
+Index into plane masks of the given port.
+*/
+uint8_t bam_port(volatile uint8_t *port) {
+    if (port == &PORTB) {
+        return 0;
+    } else if (port == &PORTC) {
+        return 1;
+    }
+    return 2;
+}
+
+
+/**
+Set brightness of the LED at the given index.
+
+@param number Index into global leds array.
+@param level Brightness, from 0 (off) to 255 (on). Only the top BAM_BITS
+    bits are used.
+*/
+void led_brightness(uint8_t number, uint8_t level) {
+    uint8_t port = bam_port(leds[number].port);
+    uint8_t mask = (1 << leds[number].pin);
+    level >>= (8 - BAM_BITS);
+    for (uint8_t i=0; i<BAM_BITS; i++) {
+        if (level & (1 << i)) {
+            bam_planes[i][port] |= mask;
+        } else {
+            bam_planes[i][port] &= ~mask;
+        }
+    }
+}
+
+
+/**
+Start timer1 interrupts and take over the LED pins.
+*/
+void bam_start() {
+    for (uint8_t i=0; i<num_leds; i++) {
+        bam_keep[bam_port(leds[i].port)] &= ~(1 << leds[i].pin);
+    }
+
+    cli();
+    TCCR1A = 0;
+    TCCR1B = (1 << WGM12) | (1 << CS10);        // CTC, no prescaler
+    OCR1A = BAM_UNIT - 1;
+    TCNT1 = 0;
+    TIMSK1 |= (1 << OCIE1A);
+    sei();
+}
+
+
+/**
+Show the next bit-plane, and time it.
+
+The counter has already restarted from zero, so OCR1A can be moved safely
+as long as the ISR finishes within BAM_UNIT cycles.
+*/
+ISR(TIMER1_COMPA_vect) {
+    static uint8_t plane = 0;
+    static uint16_t top = BAM_UNIT - 1;
+
+    if (++plane == BAM_BITS) {
+        plane = 0;
+        top = BAM_UNIT - 1;
+    } else {
+        top = (top << 1) | 1;
+    }
+
+    volatile uint8_t *masks = bam_planes[plane];
+    PORTB = (PORTB & bam_keep[0]) | masks[0];
+    PORTC = (PORTC & bam_keep[1]) | masks[1];
+    PORTD = (PORTD & bam_keep[2]) | masks[2];
+    OCR1A = top;
+}
+
+
 /**
 Turn on just the LED at the given index.
 
 @param number Index into global leds array.
 */
 void led_on(uint8_t number) {
-    volatile uint8_t *port = leds[number].port;
-    uint8_t pin = leds[number].pin;
-    *port |= (1<<pin);
+    led_brightness(number, 0xff);
 }
 
 /**
@@ -79,9 +216,7 @@ Turn off just the LED at the given index.
 @param number Index into global leds array.
 */
 void led_off(uint8_t number) {
-    volatile uint8_t *port = leds[number].port;
-    uint8_t pin = leds[number].pin;
-    *port &= ~(1<<pin);
+    led_brightness(number, 0);
 }
 
 
@@ -209,7 +344,34 @@ void cylon() {
 
 
 /**
-Prepare all LED pins in string for output.
+A 'comet' with a fading tail, bouncing along the string.
+
+Every LED's brightness decays each step, so those just passed glow dimmer and
+dimmer behind the brightest.
+*/
+void comet() {
+    static uint8_t levels[num_leds];
+    static uint8_t head = 0;
+    static int8_t direction = 1;
+
+    for (uint8_t i=0; i<num_leds; i++) {
+        levels[i] >>= 1;
+    }
+    levels[head] = 0xff;
+    for (uint8_t i=0; i<num_leds; i++) {
+        led_brightness(i, levels[i]);
+    }
+
+    if ((head == 0 && direction < 0) || (head == num_leds-1 && direction > 0)) {
+        direction = -direction;
+    }
+    head += direction;
+    _delay_ms(DELAY * 2);
+}
+
+
+/**
+Prepare all LED pins in string for output, and start PWM.
 */
 void setup() {
     volatile uint8_t *ddr;
@@ -219,13 +381,14 @@ void setup() {
         pin = leds[i].pin;
         *(ddr) |= (1<<pin);
     }
+    bam_start();
 }
 
 
 int main() {
     setup();
     while (1) {
-        cylon();
+        comet();
     }
     return 0;
 }
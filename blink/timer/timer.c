@@ -11,8 +11,8 @@ Blink an LED using timer0 to drive pin OC0A (D6) directly.
 void init_timer0() {
     TCCR0A |= (1 << WGM01);             // CTC mode
     TCCR0A |= (1 << COM0A0);            // Toggle pin
-    TCCR0B |= (1 << CS00) | (1 <<CS02); // 8x prescaler
-    OCR0A = 255;                        // 500ms
+    TCCR0B |= (1 << CS00) | (1 <<CS02); // 1024x prescaler
+    OCR0A = 255;                        // Toggle every 262ms, at 1MHz
 }
 
 
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <avr/io.h>
+
+
+/**
+Host stand-in for avr-libc's <avr/interrupt.h>.
+
+Handlers are plain functions, called by the timer simulation in
+``scheduler_test.cpp``, which also implements `cli()` and `sei()`.
+*/
+#define ISR(vector)     extern "C" void vector(void)
+
+void cli();
+void sei();
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+
+
+/**
+Host stand-in for avr-libc's <avr/io.h>: just timer2 and an LED port.
+
+Registers are plain bytes, apart from the interrupt flags, which clear when a
+one is written to them, as on the chip.
+*/
+struct FlagRegister {
+    uint8_t value;
+
+    FlagRegister& operator=(uint8_t ones) { value &= ~ones; return *this; }
+    operator uint8_t() const { return value; }
+};
+
+extern uint8_t DDRB, PORTB;
+extern uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, TIMSK2, ASSR;
+extern uint8_t SREG;
+extern FlagRegister TIFR2;
+
+
+#define PB0     0
+#define PB1     1
+
+#define TOIE2   0
+#define OCIE2A  1
+#define TOV2    0
+#define OCF2A   1
+#define CS20    0
+#define CS21    1
+#define CS22    2
+#define WGM21   1
+#define AS2     5
+#define TCN2UB  4
+#define OCR2AUB 3
+#define TCR2AUB 1
+#define TCR2BUB 0
@@ -0,0 +1,9 @@
+#pragma once
+
+
+/**
+Host stand-in for avr-libc's <avr/power.h>.
+*/
+#define clock_div_1     0
+
+inline void clock_prescale_set(uint8_t) {}
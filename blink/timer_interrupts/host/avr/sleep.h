@@ -0,0 +1,15 @@
+#pragma once
+
+
+/**
+Host stand-in for avr-libc's <avr/sleep.h>.
+
+`sleep_cpu()` runs the simulated timer until its next interrupt.
+*/
+#define SLEEP_MODE_IDLE         0
+#define SLEEP_MODE_PWR_SAVE     3
+
+inline void set_sleep_mode(uint8_t) {}
+inline void sleep_enable() {}
+inline void sleep_disable() {}
+void sleep_cpu();
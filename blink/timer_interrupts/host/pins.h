@@ -0,0 +1,11 @@
+#pragma once
+
+
+// Pins for the host check
+#define BLINK_LED       PB0
+#define BLINK_LED_DDR   DDRB
+#define BLINK_LED_PORT  PORTB
+
+#define HEARTBEAT       PB1
+#define HEARTBEAT_DDR   DDRB
+#define HEARTBEAT_PORT  PORTB
@@ -0,0 +1,205 @@
+/**
+Host check of the tickless scheduler, and the blink demo built on it.
+
+Runs the real ``scheduler.c`` and ``timer_interrupts.c`` against a simulated
+timer2, counting one tick per step. Sleeping runs the timer until an enabled
+interrupt is pending, and `sei()` lets one tick pass, so that code spinning
+with interrupts enabled still sees time move.
+
+Each scenario runs until a time limit, then checks when its tasks ran, to the
+tick. Exits with status 1 on any failure.
+*/
+
+#include <csetjmp>
+#include <cstdio>
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+#include "../scheduler.h"
+
+
+uint8_t DDRB, PORTB;
+uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, TIMSK2, ASSR;
+uint8_t SREG;
+FlagRegister TIFR2;
+
+extern "C" void TIMER2_OVF_vect(void);
+extern "C" void TIMER2_COMPA_vect(void);
+void blink_main();
+
+
+namespace {
+
+bool interrupts = false;
+uint32_t now = 0;
+uint32_t limit = 0;
+std::jmp_buf stop;
+
+// Times the blink LED was turned on and off, seen at the end of the tick
+const int max_changes = 32;
+uint32_t changes[max_changes];
+int num_changes = 0;
+
+
+void interrupt_if_pending() {
+    if ( !interrupts ) {
+        return;
+    }
+    if ( (TIFR2 & (1 << TOV2)) && (TIMSK2 & (1 << TOIE2)) ) {
+        TIFR2 = (1 << TOV2);
+        TIMER2_OVF_vect();
+    }
+    if ( (TIFR2 & (1 << OCF2A)) && (TIMSK2 & (1 << OCIE2A)) ) {
+        TIFR2 = (1 << OCF2A);
+        TIMER2_COMPA_vect();
+    }
+}
+
+
+bool is_pending() {
+    return ((TIFR2 & (1 << TOV2)) && (TIMSK2 & (1 << TOIE2))) ||
+        ((TIFR2 & (1 << OCF2A)) && (TIMSK2 & (1 << OCIE2A)));
+}
+
+
+/**
+One tick of timer2, in normal mode.
+*/
+void tick() {
+    ++now;
+    ++TCNT2;
+    if ( TCNT2 == 0 ) {
+        TIFR2.value |= (1 << TOV2);
+    }
+    if ( TCNT2 == OCR2A ) {
+        TIFR2.value |= (1 << OCF2A);
+    }
+
+    const bool led = PORTB & (1 << PB0);
+    if ( led != (num_changes % 2 == 1) && num_changes < max_changes ) {
+        changes[num_changes++] = now - 1;
+    }
+    if ( now >= limit ) {
+        std::longjmp(stop, 1);
+    }
+}
+
+
+/**
+Start from reset, running until the given time.
+*/
+void reset(uint32_t ticks) {
+    now = 0;
+    limit = ticks;
+    interrupts = false;
+    num_changes = 0;
+    PORTB = 0;
+    TIFR2.value = 0;
+}
+
+
+// Scenario tasks record when they ran
+const int max_runs = 16;
+uint32_t runs[max_runs];
+int num_runs = 0;
+
+void record() {
+    if ( num_runs < max_runs ) {
+        runs[num_runs++] = now;
+    }
+}
+
+void one_shot() {
+    record();
+}
+
+void adds_one_shot() {
+    record();
+    scheduler_after(one_shot, 10);
+}
+
+void blocker() {
+}
+
+
+int check(bool ok, const char* message) {
+    if ( !ok ) {
+        std::printf("    FAILED: %s\n", message);
+    }
+    return ok ? 0 : 1;
+}
+
+
+/**
+The blink demo: LED on for 50ms of every second, from the first.
+*/
+int check_blink() {
+    reset(5 * 7813 + 10);
+    if ( setjmp(stop) == 0 ) {
+        blink_main();
+    }
+
+    int failures = 0;
+    const uint32_t period = scheduler_ms(1000);
+    const uint32_t on_time = scheduler_ms(50);
+    failures += check(num_changes >= 10, "LED changed too few times");
+    for (int i = 0; i + 1 < num_changes; i += 2) {
+        failures += check(changes[i] == (i / 2) * period, "LED on at wrong time");
+        failures += check(changes[i + 1] - changes[i] == on_time, "LED on for wrong time");
+    }
+    std::printf("Blink demo: %d changes, %s\n", num_changes, failures ? "FAILED" : "OK");
+    return failures;
+}
+
+
+/**
+A task adding another into a slot before its own must still wake the CPU.
+*/
+int check_lower_slot() {
+    reset(3000);
+    num_runs = 0;
+    if ( setjmp(stop) == 0 ) {
+        scheduler_init();
+        scheduler_after(blocker, 1);            // Slot 0, free once run
+        scheduler_every(adds_one_shot, 1000);   // Slot 1
+        scheduler_run();
+    }
+
+    int failures = 0;
+    failures += check(num_runs >= 4, "Tasks ran too few times");
+    failures += check(runs[0] == 1000 && runs[1] == 1010, "First one-shot late");
+    failures += check(runs[2] == 2000 && runs[3] == 2010, "Second one-shot late");
+    std::printf("Task adding to lower slot: %s\n", failures ? "FAILED" : "OK");
+    return failures;
+}
+
+} // namespace
+
+
+void cli() {
+    interrupts = false;
+}
+
+
+void sei() {
+    interrupts = true;
+    tick();
+    interrupt_if_pending();
+}
+
+
+void sleep_cpu() {
+    while ( !is_pending() ) {
+        tick();
+    }
+    interrupt_if_pending();
+}
+
+
+int main() {
+    int failures = 0;
+    failures += check_blink();
+    failures += check_lower_slot();
+    return failures ? 1 : 0;
+}
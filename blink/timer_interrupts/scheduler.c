@@ -0,0 +1,258 @@
+/*
+Tickless cooperative scheduler on timer2. See scheduler.h.
+*/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pins.h"
+#include "scheduler.h"
+
+
+// Ticks of margin when arming compare match, so that it is never missed
+#define MARGIN 2
+
+
+typedef struct {
+    scheduler_task task;
+    uint32_t deadline;
+    uint32_t period;            // Zero for one-shot tasks
+} entry;
+
+
+static entry tasks[SCHEDULER_MAX_TASKS];
+
+// Scheduler time when TCNT2 last overflowed to zero
+static volatile uint32_t base = 0;
+
+
+#ifdef SCHEDULER_ASYNC
+/**
+Wait for writes to timer2 to cross into its own clock domain.
+*/
+static inline void wait_for_async(void) {
+    while (ASSR & ((1 << TCN2UB) | (1 << OCR2AUB) | (1 << TCR2AUB) | (1 << TCR2BUB))) {
+    }
+}
+#endif
+
+
+/**
+Timer2 overflow: extend the 8-bit count in software.
+*/
+ISR(TIMER2_OVF_vect) {
+    base += 256;
+}
+
+
+/**
+Timer2 compare match: a deadline in this lap of the counter. Waking is the
+point; disarm so it doesn't fire again next lap.
+*/
+ISR(TIMER2_COMPA_vect) {
+    TIMSK2 &= ~(1 << OCIE2A);
+}
+
+
+/**
+Start timer2 counting freely, with its overflow interrupt.
+*/
+void scheduler_init(void) {
+    uint8_t i;
+    for (i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        tasks[i].task = 0;
+    }
+
+    TIMSK2 = 0;
+#ifdef SCHEDULER_ASYNC
+    ASSR = (1 << AS2);
+#endif
+    TCNT2 = 0;
+    TCCR2A = 0;                                             // Normal mode
+#ifdef SCHEDULER_ASYNC
+    TCCR2B = (1 << CS22) | (1 << CS20);                     // 128x
+    wait_for_async();
+#else
+    TCCR2B = (1 << CS22) | (1 << CS21) | (1 << CS20);       // 1024x
+#endif
+    TIFR2 = (1 << TOV2) | (1 << OCF2A);
+    TIMSK2 = (1 << TOIE2);
+
+#ifdef HEARTBEAT
+    HEARTBEAT_DDR |= (1 << HEARTBEAT);
+#endif
+}
+
+
+/**
+Current time, in ticks of `SCHEDULER_TICKS_PER_SECOND`. Wraps after a while:
+compare times by subtraction.
+*/
+uint32_t scheduler_now(void) {
+    uint32_t now;
+    uint8_t sreg = SREG;
+    cli();
+    now = base + TCNT2;
+    if (TIFR2 & (1 << TOV2)) {
+        // Overflow pending, counter may have been read before it wrapped
+        now = base + 256 + TCNT2;
+    }
+    SREG = sreg;
+    return now;
+}
+
+
+static bool add(scheduler_task task, uint32_t delay, uint32_t period) {
+    uint8_t i;
+    for (i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        if (tasks[i].task == 0) {
+            tasks[i].task = task;
+            tasks[i].deadline = scheduler_now() + delay;
+            tasks[i].period = period;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+Run task every ``period`` ticks, starting one period from now.
+
+Periods are kept exactly, even if a task runs late. Returns false if the task
+table is full.
+*/
+bool scheduler_every(scheduler_task task, uint32_t period) {
+    return add(task, period, period);
+}
+
+
+/**
+Run task once, ``delay`` ticks from now. Returns false if the table is full.
+*/
+bool scheduler_after(scheduler_task task, uint32_t delay) {
+    return add(task, delay, 0);
+}
+
+
+/**
+Remove every entry for a task.
+*/
+void scheduler_cancel(scheduler_task task) {
+    uint8_t i;
+    for (i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        if (tasks[i].task == task) {
+            tasks[i].task = 0;
+        }
+    }
+}
+
+
+/**
+Run every task that is due, and return the earliest deadline left.
+
+The deadline is found in a second pass over the whole table, as a task may
+add entries to slots the first has already passed.
+
+Returns false if there are no tasks at all.
+*/
+static bool run_due(uint32_t* next) {
+    bool any = false;
+    uint8_t i;
+    for (i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        scheduler_task task = tasks[i].task;
+        if (task == 0) {
+            continue;
+        }
+        if ((int32_t)(scheduler_now() - tasks[i].deadline) >= 0) {
+            if (tasks[i].period) {
+                tasks[i].deadline += tasks[i].period;
+            } else {
+                tasks[i].task = 0;
+            }
+            task();
+        }
+    }
+
+    for (i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        if (tasks[i].task && (! any || (int32_t)(tasks[i].deadline - *next) < 0)) {
+            *next = tasks[i].deadline;
+            any = true;
+        }
+    }
+    return any;
+}
+
+
+/**
+Sleep until the deadline, or the next overflow, whichever is first.
+
+Does not sleep if the deadline is too close to arm, or an overflow has not yet
+been counted. Call with interrupts off; returns with them on.
+*/
+static void sleep_until(uint32_t deadline) {
+    const uint8_t count = TCNT2;
+    const int32_t remaining = (int32_t)(deadline - base);
+    if (TIFR2 & (1 << TOV2)) {
+        sei();
+        return;
+    }
+    if (remaining < 256) {
+        if (remaining - count < MARGIN) {
+            sei();
+            return;
+        }
+        OCR2A = remaining;
+        TIFR2 = (1 << OCF2A);
+        TIMSK2 |= (1 << OCIE2A);
+    } else {
+        TIMSK2 &= ~(1 << OCIE2A);
+    }
+#ifdef SCHEDULER_ASYNC
+    wait_for_async();
+#endif
+
+#ifdef HEARTBEAT
+    HEARTBEAT_PORT &= ~(1 << HEARTBEAT);
+#endif
+    sleep_enable();
+    sei();                      // Takes effect after the next instruction...
+    sleep_cpu();                // ...so no interrupt can slip in before sleeping
+    sleep_disable();
+}
+
+
+/**
+Run tasks forever, sleeping between deadlines.
+*/
+void scheduler_run(void) {
+#ifdef SCHEDULER_ASYNC
+    set_sleep_mode(SLEEP_MODE_PWR_SAVE);
+#else
+    set_sleep_mode(SLEEP_MODE_IDLE);
+#endif
+    sei();
+    while (true) {
+        uint32_t next = 0;
+#ifdef HEARTBEAT
+        HEARTBEAT_PORT |= (1 << HEARTBEAT);
+#endif
+        if (! run_due(&next)) {
+            next = scheduler_now() + 0x10000;       // Nothing to do
+        }
+
+        // Sleep through the overflows, until the deadline
+        while ((int32_t)(scheduler_now() - next) < 0) {
+            cli();
+            sleep_until(next);
+#ifdef SCHEDULER_ASYNC
+            // TCNT2 reads wrong until one TOSC1 cycle after waking
+            TCCR2A = 0;
+            wait_for_async();
+#endif
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+A tickless, cooperative scheduler on timer2.
+
+Rather than waking up every millisecond to count, timer2's compare match is set
+for the next deadline, and the CPU sleeps until then. Tasks are plain
+functions, run one after the other from the main loop, so they must return
+quickly, but need no locking::
+
+    void blink(void) {
+        BLINK_LED_PORT ^= (1 << BLINK_LED);
+    }
+
+    scheduler_init();
+    scheduler_every(blink, scheduler_ms(500));
+    scheduler_run();                            // Never returns
+
+Timer2 counts freely, and its overflow ISR extends the count into a 32-bit
+clock of `scheduler_now()` ticks. The compare match interrupt is armed for the
+deadline once it falls within the counter's current lap of 256 ticks. Further
+deadlines are reached by sleeping from overflow to overflow, each costing about
+150 cycles awake (hand-estimated) before sleeping again. The table gives the
+longest sleep between overflows.
+
+    ===========  =========  ==========  ==========  ===================
+    Clock        Prescaler  Tick        Longest     Sleep mode
+                                        sleep
+    ===========  =========  ==========  ==========  ===================
+    1MHz         1024       1.024ms     262ms       Idle
+    8MHz         1024       128us       32.8ms      Idle
+    16MHz        1024       64us        16.4ms      Idle
+    32.768kHz    128        3.9ms       1s          Power-save
+    ===========  =========  ==========  ==========  ===================
+
+Timer2 clocked from the CPU stops in every sleep mode deeper than idle. Define
+``SCHEDULER_ASYNC`` when a 32.768kHz watch crystal is fitted to TOSC1 and TOSC2
+(PB6 and PB7, in place of the CPU's crystal) to run timer2 from it, and sleep in
+power-save mode instead, drawing under 1uA rather than about 1mA.
+
+If ``HEARTBEAT`` is defined (in ``pins.h``), that pin is high while tasks are
+running and low while asleep. Its duty-cycle is the CPU load.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+#ifndef SCHEDULER_MAX_TASKS
+#define SCHEDULER_MAX_TASKS 4
+#endif
+
+#ifdef SCHEDULER_ASYNC
+#define SCHEDULER_CLOCK 32768UL
+#define SCHEDULER_PRESCALER 128UL
+#else
+#define SCHEDULER_CLOCK F_CPU
+#define SCHEDULER_PRESCALER 1024UL
+#endif
+
+/// Scheduler clock ticks in a second, rounded down
+#define SCHEDULER_TICKS_PER_SECOND (SCHEDULER_CLOCK / SCHEDULER_PRESCALER)
+
+/// Milliseconds to ticks, rounded to nearest. Use with constants.
+#define scheduler_ms(ms) \
+    ((uint32_t)(((uint64_t)(ms) * SCHEDULER_CLOCK + 500UL * SCHEDULER_PRESCALER) / \
+        (1000UL * SCHEDULER_PRESCALER)))
+
+
+typedef void (*scheduler_task)(void);
+
+
+void scheduler_init(void);
+bool scheduler_every(scheduler_task task, uint32_t period);
+bool scheduler_after(scheduler_task task, uint32_t delay);
+void scheduler_cancel(scheduler_task task);
+uint32_t scheduler_now(void);
+void scheduler_run(void);
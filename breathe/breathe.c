@@ -42,7 +42,7 @@ void init_timer2()
 {
     // Waveform generation mode (WGM)
     TCCR2A |= (1 << WGM21);         // CTC mode, zero to OCR2A
-    OCR2A = 120;                    // = F_CPU/(prescaler * 1000ms) - 1
+    OCR2A = 120;                    // 1MHz/(128 * (120 + 1)) = 64.6Hz
 
     // Clock select (CS)
     TCCR2B |= (1 << CS22) | (0 << CS21) | (1 << CS20);    // 128
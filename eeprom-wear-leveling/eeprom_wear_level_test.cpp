@@ -1,6 +1,16 @@
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 
 using std::cout;
@@ -10,16 +20,21 @@ using std::endl;
 namespace wear_leveling {
 
 
-static const size_t hardware_eeprom_size = 512;
-
-
 struct Record {
     uint32_t last_prime;
 };
 
 
 /**
-Sorta-kinda mock-out access to EEPROM.
+Simulated EEPROM, fast enough for lifetime tests of millions of saves.
+
+The contents are memory-mapped from ``eeprom.bin``, so can be inspected after
+a run. Every erase and write of each byte is counted, against its endurance,
+and the time each would take on the chip is totalled.
+
+To test recovery from a reset, `tear()` makes a later write stop part-way,
+then drops every write after it, as if the power had failed. `power_on()`
+restores it.
 
 Real EEPROM looks like this:
 
@@ -27,7 +42,8 @@ Real EEPROM looks like this:
 
     uint8_t EEDR (EEPROM Data Register)
     uint8_t EECR (EEPROM Control Register)
-        * Bits 7 to 4: Reserved Bits
+        * Bits 7 to 6: Reserved Bits
+        * Bits 5 to 4: EEPM1:0 (EEPROM Programming Mode, ATmega328P)
         * Bit 3: EERIE (EEPROM Ready Interrupt Enable)
         * Bit 2: EEMWE: EEPROM Master Write Enable
         * Bit 1: EEWE: EEPROM Write Enable
@@ -36,37 +52,130 @@ Real EEPROM looks like this:
         * Bits 15 to 10: Reserved Bits
         * Bits 9 to 0: EEPROM Address
 
+Erasing sets every bit of a byte, and writing can only clear bits. EEPM1:0
+chooses to do either or both::
+
+    ======  ===========  ======  ================================
+    EEPM    Mode         Time    Result
+    ======  ===========  ======  ================================
+    00      Erase+write  3.4ms   value
+    01      Erase only   1.8ms   0xff
+    10      Write only   1.8ms   old & value
+    ======  ===========  ======  ================================
 */
 class FakeEEPROM {
     private:
-        FILE* fp;
+        int fd;
+        uint8_t* data;
+        size_t size;
+        std::vector<uint32_t> erase_counts;
+        std::vector<uint32_t> write_counts;
+        uint64_t elapsed;
+        uint64_t reads;
+        bool powered;
+        uint32_t writes_until_tear;
+        uint8_t torn_bits;
 
     public:
-        FakeEEPROM();
+        enum class Mode : uint8_t {
+            erase_write = 0,
+            erase = 1,
+            write = 2,
+        };
+
+        explicit FakeEEPROM(size_t size=512, const char* path="eeprom.bin");
         ~FakeEEPROM();
+        FakeEEPROM(const FakeEEPROM&) = delete;
+        FakeEEPROM& operator=(const FakeEEPROM&) = delete;
 
-    void write(uint16_t address, uint8_t value);
+    static uint16_t microseconds(Mode mode);
+    void write(uint16_t address, uint8_t value, Mode mode=Mode::erase_write);
     uint8_t read(uint16_t address);
+
+    uint32_t get_erases(uint16_t address) { return erase_counts[address]; }
+    uint32_t get_writes(uint16_t address) { return write_counts[address]; }
+    uint32_t get_max_wear();
+    uint64_t get_microseconds() { return elapsed; }
+    uint64_t get_reads() { return reads; }
+
+    void tear(uint32_t writes, uint8_t completed_bits=0x00);
+    bool is_powered() { return powered; }
+    void power_on() { powered = true; }
 };
 
 
-FakeEEPROM::FakeEEPROM() {
-    fp = fopen("eeprom.bin", "w+");
-    uint8_t buffer[hardware_eeprom_size];
-    for(size_t i=0; i < hardware_eeprom_size; ++i) {
-        // Erase like real EEPROM
-        buffer[i] = 0xff;
+/**
+Args:
+    size: Bytes of EEPROM: 512 on the ATmega328P, 1K or 4K on bigger parts.
+    path: File to map the contents from; erased first.
+*/
+FakeEEPROM::FakeEEPROM(size_t size, const char* path) :
+        size(size), erase_counts(size), write_counts(size) {
+    elapsed = 0;
+    reads = 0;
+    powered = true;
+    writes_until_tear = 0;
+    torn_bits = 0;
+
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    data = NULL;
+    if ( fd >= 0 && ftruncate(fd, size) == 0 ) {
+        void* mapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if ( mapped != MAP_FAILED ) {
+            data = static_cast<uint8_t*>(mapped);
+        }
+    }
+    if ( data == NULL ) {
+        perror(path);
+        exit(1);
     }
-    fwrite(buffer, 1, hardware_eeprom_size, fp);
+
+    // Erase like real EEPROM
+    std::fill(data, data + size, 0xff);
 }
 
 
 FakeEEPROM::~FakeEEPROM() {
-    if ( fp != NULL) {
-        fclose(fp);
+    munmap(data, size);
+    close(fd);
+}
+
+
+/**
+Most erases or writes of any one byte. Compare with the rated endurance,
+100,000 cycles on the ATmega328P.
+*/
+uint32_t FakeEEPROM::get_max_wear() {
+    uint32_t most = 0;
+    for(size_t i=0; i < size; ++i) {
+        most = std::max(most, std::max(erase_counts[i], write_counts[i]));
     }
+    return most;
+}
+
+
+/**
+Lose power part-way through a later write.
+
+Args:
+    writes: Writes to complete first; the one after is torn.
+    completed_bits: Mask of bits that did reach their new value in the torn
+        write. The rest keep the old value, except that an erase+write tears
+        after its erase, leaving them set.
+*/
+void FakeEEPROM::tear(uint32_t writes, uint8_t completed_bits) {
+    writes_until_tear = writes + 1;
+    torn_bits = completed_bits;
 }
 
+/**
+Time taken by one byte in the given mode.
+*/
+uint16_t FakeEEPROM::microseconds(Mode mode) {
+    return (mode == Mode::erase_write) ? 3400 : 1800;
+}
+
+
 /**
 EEPROM Write
 
@@ -77,19 +186,44 @@ EEPROM Write
 5. Within four clock cycles after 4th step, set EEWE(Eeprom Write Enable)
   to trigger the EEPROM Write operation.
 
-For example::
+For example, on the ATmega328P, where the bits are renamed EEMPE and EEPE::
 
-    while(EECR & (1<<EEWE));
+    while(EECR & (1<<EEPE));
     EEAR = address;
     EEDR = value;
-    EECR |= (1<<EEMWE);
-    EECR |= (1<<EEWE);
+    EECR = (EECR & ~(3 << EEPM0)) | (mode << EEPM0);
+    EECR |= (1<<EEMPE);
+    EECR |= (1<<EEPE);
     EEAR = 0;
 
 */
-void FakeEEPROM::write(uint16_t address, uint8_t value) {
-    fseek(fp, address, SEEK_SET);
-    fputc(value, fp);
+void FakeEEPROM::write(uint16_t address, uint8_t value, Mode mode) {
+    if ( !powered ) {
+        return;
+    }
+
+    uint8_t old = data[address];
+    if ( mode == Mode::erase ) {
+        value = 0xff;
+    } else if ( mode == Mode::write ) {
+        value &= old;
+    }
+    if ( mode != Mode::write ) {
+        ++erase_counts[address];
+    }
+    if ( mode != Mode::erase ) {
+        ++write_counts[address];
+    }
+    elapsed += microseconds(mode);
+
+    if ( writes_until_tear && --writes_until_tear == 0 ) {
+        if ( mode == Mode::erase_write ) {
+            old = 0xff;
+        }
+        value = (value & torn_bits) | (old & ~torn_bits);
+        powered = false;
+    }
+    data[address] = value;
 }
 
 
@@ -112,105 +246,569 @@ For example:
 
 */
 uint8_t FakeEEPROM::read(uint16_t address) {
-    fseek(fp, address, SEEK_SET);
-    return fgetc(fp);
+    ++reads;
+    return data[address];
 }
 
 
+
+/**
+Time taken, and wear caused, by a `RecordStore::save()`.
+
+Every erase or write of a byte counts against its endurance, so both are
+totalled. Wide enough to total many saves, as well as one.
+*/
+struct Cost {
+    uint32_t microseconds;
+    uint32_t erases;
+    uint32_t writes;
+
+    Cost& operator+=(const Cost& other) {
+        microseconds += other.microseconds;
+        erases += other.erases;
+        writes += other.writes;
+        return *this;
+    }
+};
+
+
+/**
+Smallest unsigned type that can count to n.
+*/
+template <size_t n>
+using Index = typename std::conditional<(n <= UINT8_MAX), uint8_t, uint16_t>::type;
+
+
 /**
 Use entire EEPROM to store a single Record.
 
 Many copies are written across the whole address
 
-Taking care to extend lifetime using wear leveling.
+Taking care to extend lifetime using wear leveling. Records are written to
+each slot in turn, around a ring. Every slot has a status byte, holding the
+'lap' of the ring on which that slot was last written::
+
+    Address  0     1 .. num_records      num_records + 1 ..
+             Skip  Status bytes          Records
+
+Within a lap, slots up to the newest hold the current lap, and the rest hold
+the previous one (or are erased, on the first lap)::
+
+    Status   fc fc fc fc fe fe fe fe fe fe
+                      ^ Newest record
+
+That sequence is monotonic, so `load()` finds the newest by binary search,
+reading only about log2(num_records) status bytes rather than all of them.
+
+Writes are differential: each byte is read first, and left alone if it
+already holds the new value. Bytes that only need bits cleared use the
+write-only mode, in half the time and without an erase. Saving a record
+identical to the newest does nothing at all.
+
+Laps are numbered so that moving to the next only clears a bit: 0xfe, 0xfc,
+0xf8 ... 0x80, 0x00, then back to 0xfe. So seven laps in eight update their
+status bytes write-only, even over erased EEPROM on the first lap.
+
+Saving doesn't wait for the EEPROM. `save()` copies the record into a buffer
+and returns at once; the EEPROM ready interrupt then writes one byte each time
+the last has finished, record first and status last::
+
+    ISR(EE_READY_vect) {
+        store.on_ready();
+        if ( !store.is_pending() ) {
+            EECR &= ~(1 << EERIE);
+        }
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        store.save();
+    }
+    EECR |= (1 << EERIE);
+
+A reset at any point finds either the previous record or the new one, as the
+new slot only counts once its status byte is written. Saving again before then
+replaces the buffer and starts the same slot over, so a burst of changes costs
+one slot. Even a torn status byte is safe. Most lap changes clear one bit, so a
+torn one reads as either lap. Going from 0x00 back to 0xfe takes an erase and
+a write, and a reset between them leaves 0xff: any slot but the first then
+reads as older, and for the first, `load()` falls back to the last slot.
+
+`flush()` finishes the writes itself, say before sleeping. It calls
+`on_ready()` from the main loop, so turn the interrupt off first::
+
+    EECR &= ~(1 << EERIE);
+    store.flush();
+
+The layout is fixed at compile time. Slot indices are 8-bit where they can be,
+so a 4K part storing a 4-byte record gets all 819 slots::
+
+    =====================  ======  ======  ======
+    Record size            512B    1K      4K
+    =====================  ======  ======  ======
+    1 byte                 255     511     2047
+    4 bytes                102     204     819
+    32 bytes               15      31      124
+    =====================  ======  ======  ======
+
+Args:
+    T: Record type. Copied byte-for-byte, so must be trivially copyable.
+    eeprom_size: Bytes of EEPROM.
 */
+template <typename T, size_t eeprom_size>
 class RecordStore {
+    public:
+        static constexpr size_t record_size = sizeof(T);
+        static constexpr size_t num_records = (eeprom_size - 1) / (record_size + 1);
+        using index_type = Index<num_records>;
+
+        static_assert(std::is_trivially_copyable<T>::value,
+            "Records are stored byte-for-byte");
+        static_assert(num_records >= 2,
+            "Record too big: need two slots, so a reset while saving keeps one");
+        static_assert(eeprom_size <= UINT16_MAX + 1, "EEPROM addresses are 16-bit");
+
     private:
+        static const uint8_t erased = 0xff;
+        static const uint8_t first_lap = 0xfe;
 
-        const Record& record;
-        FakeEEPROM& eeprom;
-        uint8_t current_index;
-        uint8_t num_records;
-        uint8_t record_size;
+        // Bytes of record, then status, then nothing left to write
+        static constexpr size_t idle = record_size + 1;
 
+        T& record;
+        FakeEEPROM& eeprom;
+        index_type current_index;
+        uint8_t current_lap;
+
+        // Save in progress, else the newest record, so saving never reads
+        // EEPROM (and waits for it) with interrupts off
+        T buffer;
+        index_type buffer_index;
+        uint8_t buffer_lap;
+
+        // Polled by the main loop while the interrupt changes it, so volatile,
+        // and a single byte for records under 255 bytes, so read in one go
+        volatile Index<idle> next_byte;
+
+        static uint16_t status_address(index_type index) { return 1 + index; }
+        static uint16_t record_address(index_type index) {
+            return 1 + num_records + (index * record_size);
+        }
+        static uint8_t next_lap(uint8_t lap);
 
-        void update_status();
-        void update_record();
+        void read_record();
+        bool is_unchanged();
+        Cost update_byte(uint16_t address, uint8_t value);
 
     public:
-        RecordStore(const Record& record, FakeEEPROM& eeprom);
-        uint8_t get_record_size() { return record_size; }
-        uint8_t get_num_records() { return num_records; }
+        RecordStore(T& record, FakeEEPROM& eeprom);
+        static constexpr size_t get_record_size() { return record_size; }
+        static constexpr size_t get_num_records() { return num_records; }
+        index_type get_current_index() { return current_index; }
+        bool load();
         void save();
+        bool is_pending() { return next_byte != idle; }
+        Cost on_ready();
+        Cost flush();
 };
 
 
-RecordStore::RecordStore(const Record& record, FakeEEPROM& eeprom) :
+template <typename T, size_t eeprom_size>
+RecordStore<T, eeprom_size>::RecordStore(T& record, FakeEEPROM& eeprom) :
         record(record), eeprom(eeprom) {
     current_index = 0;
-    record_size = sizeof(record);
-    num_records = (hardware_eeprom_size - 1) / (record_size + 1);
+    current_lap = erased;
+    next_byte = idle;
 };
 
 
-void RecordStore::save() {
-    update_status();
-    update_record();
+/**
+Lap following the given one: clear the lowest set bit, or start again.
+*/
+template <typename T, size_t eeprom_size>
+uint8_t RecordStore<T, eeprom_size>::next_lap(uint8_t lap) {
+    if ( lap == 0 ) {
+        return first_lap;
+    }
+    return lap << 1;
 }
 
 
 /**
-Update the status buffer for the current position.
+Find newest record, and read it into our record.
+
+Call before saving, never while a save is pending.
+
+Returns:
+    False if nothing has been saved yet, leaving record untouched.
 */
-void RecordStore::update_status() {
-    uint16_t start = 1;
-    uint16_t end = (num_records + 1);
+template <typename T, size_t eeprom_size>
+bool RecordStore<T, eeprom_size>::load() {
+    current_index = 0;
+    current_lap = eeprom.read(status_address(0));
+    if ( current_lap == erased ) {
+        // Blank, unless a reset tore the first status of a new lap after its
+        // erase. Then the newest is the last of the previous lap.
+        current_index = num_records - 1;
+        current_lap = eeprom.read(status_address(current_index));
+        if ( current_lap == erased ) {
+            current_index = 0;
+            return false;
+        }
+        read_record();
+        return true;
+    }
+
+    // Last slot of the current lap, in [lower, upper)
+    index_type lower = 0;
+    uint16_t upper = num_records;
+    while ( (upper - lower) > 1 ) {
+        index_type middle = lower + ((upper - lower) / 2);
+        if ( eeprom.read(status_address(middle)) == current_lap ) {
+            lower = middle;
+        } else {
+            upper = middle;
+        }
+    }
+    current_index = lower;
+    read_record();
+    return true;
+}
+
 
-    // Save test bit pattern
-    uint8_t test_value = 1;
-    for(uint16_t address = start; address < end; ++address) {
-        eeprom.write(address, test_value);
-        ++test_value;
+/**
+Read the record in the current slot.
+*/
+template <typename T, size_t eeprom_size>
+void RecordStore<T, eeprom_size>::read_record() {
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(&record);
+    uint16_t address = record_address(current_index);
+    for(size_t i = 0; i < record_size; ++i) {
+        bytes[i] = eeprom.read(address + i);
     }
+    buffer = record;
 }
 
 
 /**
-Save the current value of our record into the current position.
+Start saving our record into the next slot, unless it is already the newest.
+
+Returns at once, with the record copied. If a save is already pending, it is
+replaced. Not safe against `on_ready()`: disable interrupts around it.
 */
-void RecordStore::update_record() {
-    uint16_t start = (num_records + 1);
-    uint16_t end = start + (record_size * num_records);
+template <typename T, size_t eeprom_size>
+void RecordStore<T, eeprom_size>::save() {
+    if ( is_unchanged() ) {
+        return;
+    }
+    if ( !is_pending() ) {
+        buffer_index = current_index;
+        buffer_lap = current_lap;
+        if ( current_lap == erased ) {
+            buffer_index = 0;
+            buffer_lap = first_lap;
+        } else if ( ++buffer_index == num_records ) {
+            buffer_index = 0;
+            buffer_lap = next_lap(current_lap);
+        }
+    }
+    buffer = record;
+    next_byte = 0;
+}
 
-    // Save test bit pattern
-    uint8_t i;
-    uint8_t test_value = 1;
 
-    uint16_t address = start;
-    while (address < end) {
-        // Write each byte of record
-        for(i = 0; i < record_size; ++i) {
-            eeprom.write(address, test_value);
-            ++address;
+/**
+Is our record the same as the one pending, or else the newest?
+
+Compares against the buffer only, never EEPROM.
+*/
+template <typename T, size_t eeprom_size>
+bool RecordStore<T, eeprom_size>::is_unchanged() {
+    if ( !is_pending() && current_lap == erased ) {
+        return false;
+    }
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+    const uint8_t* newest = reinterpret_cast<const uint8_t*>(&buffer);
+    for(size_t i = 0; i < record_size; ++i) {
+        if ( newest[i] != bytes[i] ) {
+            return false;
         }
-        ++test_value;
     }
+    return true;
+}
+
+
+/**
+Start the next byte of a pending save; call from the EE_READY interrupt.
+
+Bytes that already hold their value are passed over, so at most one write is
+started per call. Once the status byte is written, the new record is newest.
+
+Returns:
+    EEPROM time and wear spent.
+*/
+template <typename T, size_t eeprom_size>
+Cost RecordStore<T, eeprom_size>::on_ready() {
+    Cost cost = {};
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&buffer);
+    const uint16_t address = record_address(buffer_index);
+    Index<idle> byte = next_byte;
+    while ( byte < record_size && cost.microseconds == 0 ) {
+        cost = update_byte(address + byte, bytes[byte]);
+        ++byte;
+    }
+    if ( byte == record_size && cost.microseconds == 0 ) {
+        cost = update_byte(status_address(buffer_index), buffer_lap);
+        current_index = buffer_index;
+        current_lap = buffer_lap;
+        byte = idle;
+    }
+    next_byte = byte;
+    return cost;
+}
+
+
+/**
+Finish any pending save, waiting on the EEPROM.
+
+Calls `on_ready()` itself, so the EE_READY interrupt must be off: clear EERIE
+first, or disable interrupts around it.
+
+Returns:
+    EEPROM time and wear spent.
+*/
+template <typename T, size_t eeprom_size>
+Cost RecordStore<T, eeprom_size>::flush() {
+    Cost cost = {};
+    while ( is_pending() ) {
+        cost += on_ready();
+    }
+    return cost;
+}
+
+
+/**
+Change one byte of EEPROM, in the quickest mode that will do.
+*/
+template <typename T, size_t eeprom_size>
+Cost RecordStore<T, eeprom_size>::update_byte(uint16_t address, uint8_t value) {
+    using Mode = FakeEEPROM::Mode;
+    const uint8_t old = eeprom.read(address);
+    Mode mode;
+    Cost cost = {};
+    if ( old == value ) {
+        return cost;
+    } else if ( (old & value) == value ) {
+        mode = Mode::write;
+        cost.writes = 1;
+    } else if ( value == erased ) {
+        mode = Mode::erase;
+        cost.erases = 1;
+    } else {
+        mode = Mode::erase_write;
+        cost.erases = 1;
+        cost.writes = 1;
+    }
+    eeprom.write(address, value, mode);
+    cost.microseconds = FakeEEPROM::microseconds(mode);
+    return cost;
 }
 
 
 } // namespace wear_leveling
 
 
+/**
+Save many times, going around the ring until the lap numbers wrap, and check
+that a fresh store (as after a reset) finds the newest record every time.
+
+Saves are written one interrupt at a time, checking that a reset after any
+of them would find either the previous record or the new one.
+
+Also check that saving an unchanged record costs nothing, and report the
+average cost of a save against rewriting every byte.
+
+Returns:
+    Number of failures.
+*/
+template <typename T, size_t eeprom_size>
+int check_store(const char* name) {
+    using Store = wear_leveling::RecordStore<T, eeprom_size>;
+    wear_leveling::FakeEEPROM eeprom(eeprom_size);
+    T record = {};
+    T loaded = {};
+    Store store(record, eeprom);
+    Store reloaded(loaded, eeprom);
+
+    int failures = 0;
+    if ( reloaded.load() ) {
+        cout << "Blank EEPROM loaded a record" << endl;
+        ++failures;
+    }
+    wear_leveling::Cost total = {};
+    const uint32_t num_saves = (10 * Store::num_records) + 7;
+    for(uint32_t i = 1; i <= num_saves; ++i) {
+        const T previous = record;
+        record = static_cast<T>(i);
+        const uint64_t reads = eeprom.get_reads();
+        store.save();
+        if ( eeprom.get_reads() != reads ) {
+            cout << "Save " << i << " read EEPROM" << endl;
+            ++failures;
+        }
+        while ( store.is_pending() ) {
+            total += store.on_ready();
+            bool found = reloaded.load();
+            if ( store.is_pending() ? (found != (i > 1) || (found && loaded != previous))
+                    : (!found || loaded != record) ) {
+                cout << "Save " << i << " reset while writing loses record" << endl;
+                ++failures;
+            }
+        }
+        if ( reloaded.get_current_index() != store.get_current_index() ) {
+            cout << "Save " << i << " loaded the wrong slot" << endl;
+            ++failures;
+        }
+        reloaded.save();
+        if ( reloaded.is_pending() ) {
+            cout << "Save " << i << " just loaded, but wrote" << endl;
+            ++failures;
+        }
+        const uint64_t unchanged_reads = eeprom.get_reads();
+        store.save();
+        if ( store.is_pending() ) {
+            cout << "Save " << i << " unchanged, but wrote" << endl;
+            ++failures;
+        }
+        if ( eeprom.get_reads() != unchanged_reads ) {
+            cout << "Save " << i << " unchanged, but read EEPROM" << endl;
+            ++failures;
+        }
+    }
+
+    if ( eeprom.get_microseconds() != total.microseconds ) {
+        cout << "Saves cost " << total.microseconds << "us, but EEPROM took ";
+        cout << eeprom.get_microseconds() << "us" << endl;
+        ++failures;
+    }
+
+    // Saving again part-way through rewrites the same slot
+    record = static_cast<T>(0);
+    store.save();
+    store.on_ready();
+    record = static_cast<T>(1);
+    store.save();
+    store.flush();
+    if ( !reloaded.load() || loaded != record ||
+            reloaded.get_current_index() != store.get_current_index() ) {
+        cout << "Save while pending loaded the wrong record" << endl;
+        ++failures;
+    }
+
+    // Every byte of record and status, erased and rewritten
+    const double full_ms = (Store::record_size + 1) * 3.4;
+    cout << name << " in " << eeprom_size << " bytes: ";
+    cout << Store::num_records << " slots, ";
+    cout << sizeof(typename Store::index_type) << "-byte index, ";
+    cout << (failures ? "FAILED" : "OK") << endl;
+    cout << "    per save: " << (total.microseconds / 1000.0 / num_saves);
+    cout << "ms (not " << full_ms << "ms), ";
+    cout << (static_cast<double>(total.erases) / num_saves) << " erases and ";
+    cout << (static_cast<double>(total.writes) / num_saves) << " writes (not ";
+    cout << (Store::record_size + 1) << " of each)" << endl;
+    return failures;
+}
+
+
+/**
+Lose power part-way through saves, over and over, each time checking that
+the record loaded after the reset is either the last saved or the one being
+saved when power failed.
+
+Args:
+    name: Record type, to report.
+    completed_bits: Bits of the torn byte that reach their new value.
+
+Returns:
+    Number of failures.
+*/
+template <typename T, size_t eeprom_size>
+int check_torn(const char* name, uint8_t completed_bits) {
+    using Store = wear_leveling::RecordStore<T, eeprom_size>;
+    wear_leveling::FakeEEPROM eeprom(eeprom_size);
+    srand(completed_bits);
+
+    int failures = 0;
+    bool any = false;
+    T committed = {};
+    T attempted = {};
+    const uint32_t num_resets = 20 * Store::num_records;
+    for(uint32_t i = 0; i < num_resets; ++i) {
+        T record = {};
+        Store store(record, eeprom);
+        bool found = store.load();
+        if ( found ? (record != committed && record != attempted) : any ) {
+            cout << "Reset " << i << " lost record" << endl;
+            ++failures;
+        }
+        if ( found ) {
+            committed = record;
+            any = true;
+        }
+
+        // Save until power fails somewhere in the next few saves
+        eeprom.tear(rand() % (4 * (Store::record_size + 1)), completed_bits);
+        while ( eeprom.is_powered() ) {
+            record = static_cast<T>(committed + 1);
+            attempted = record;
+            store.save();
+            store.flush();
+            if ( eeprom.is_powered() ) {
+                committed = record;
+                any = true;
+            }
+        }
+        eeprom.power_on();
+    }
+
+    cout << name << " torn keeping bits 0x" << std::hex;
+    cout << static_cast<int>(completed_bits) << std::dec << ": ";
+    cout << num_resets << " resets, ";
+    cout << (failures ? "FAILED" : "OK") << endl;
+    return failures;
+}
+
+
+/**
+Save a changing record a million times, and see how worn the EEPROM gets.
+*/
+void simulate_lifetime() {
+    using Store = wear_leveling::RecordStore<wear_leveling::Record, 512>;
+    const uint32_t num_saves = 1000000;
+    const uint32_t endurance = 100000;
+    wear_leveling::FakeEEPROM eeprom(512);
+    wear_leveling::Record record = {};
+    Store store(record, eeprom);
+
+    for(uint32_t i = 1; i <= num_saves; ++i) {
+        record.last_prime = i;
+        store.save();
+        store.flush();
+    }
+
+    const uint32_t wear = eeprom.get_max_wear();
+    cout << num_saves << " saves wear the most-used byte " << wear << " times, ";
+    cout << "and take " << (eeprom.get_microseconds() / 1000000) << "s." << endl;
+    cout << "Rated for " << endurance << " cycles, the EEPROM lasts about ";
+    cout << (static_cast<uint64_t>(num_saves) * endurance / wear) << " saves." << endl;
+}
+
+
 int main(int argc, char** argv) {
-    wear_leveling::Record record = {
-        .last_prime=999983
-    };
-    auto eeprom = wear_leveling::FakeEEPROM();
-    auto store = wear_leveling::RecordStore(record, eeprom);
+    using Store = wear_leveling::RecordStore<wear_leveling::Record, 512>;
 
     // Cast to to 'int' to avoid problem printing 'uint8_t' as 'char'
-    int structure_size = static_cast<int>(store.get_record_size());
-    int leveling_ratio = static_cast<int>(store.get_num_records());
+    int structure_size = static_cast<int>(Store::get_record_size());
+    int leveling_ratio = static_cast<int>(Store::get_num_records());
 
     cout << endl;
     cout << "We have 512 bytes of WearLeveling storage, ";
@@ -223,10 +821,26 @@ int main(int argc, char** argv) {
     cout << endl;
     cout << "The greatest integer function of 511 / " << (structure_size + 1);
     cout << " gives a wear leveling ratio of " << leveling_ratio << endl;
+    cout << endl;
 
-    store.save();
-    record.last_prime = 97;
-    store.save();
+    int failures = 0;
+    failures += check_store<uint32_t, 512>("uint32_t");
+    failures += check_store<uint8_t, 512>("uint8_t");
+    failures += check_store<uint8_t, 1024>("uint8_t");
+    failures += check_store<uint32_t, 4096>("uint32_t");
+    failures += check_store<uint64_t, 4096>("uint64_t");
+    cout << endl;
 
-    return 0;
+    const uint8_t masks[] = {0x00, 0x01, 0x0f, 0xf0, 0xfe, 0xff};
+    for(uint8_t mask : masks) {
+        failures += check_torn<uint32_t, 512>("uint32_t", mask);
+        failures += check_torn<uint8_t, 512>("uint8_t", mask);
+    }
+    cout << endl;
+
+    simulate_lifetime();
+
+    cout << endl;
+    cout << (failures ? "FAILED" : "OK") << endl;
+    return failures ? 1 : 0;
 }
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <stdint.h>
+#include <avr/io.h>
+
+#include "transport.h"
+
+
+namespace max7219 {
+
+
+namespace fixed {
+
+
+/**
+Driver for a daisy-chain of MAX7219 chips.
+
+Each chip's DOUT feeds the next chip's DIN, and all share clock and chip select.
+While chip select ('Load') is low every chip acts as a 16-bit shift register, so
+a frame of N 16-bit words fills the whole chain. Raising chip select latches all
+of them at once.
+
+Chips are numbered from zero, starting with the one wired to the MCU. As the
+first word shifted out ends up in the last chip, words are sent in reverse.
+
+Chips that are not being updated are sent the no-op register (0x00), so one
+chip can be changed without disturbing its neighbours. Better still, change the
+same register on every chip together: one frame, one load pulse::
+
+    auto chain = max7219::fixed::Cascade<16, max7219::PortB, PB2, PB3, PB4>();
+    chain.init();
+    uint8_t row[16];
+    ...
+    chain.set_row(3, row);
+
+A full update of 8 rows across 16 chips is 8 frames, 8 load pulses, rather
+than the 128 needed when addressing chips one at a time (each of which
+would also have had to shift all 16 words anyway).
+
+Args:
+    num_chips: Number of chips in the chain.
+    Port, mosi, clock, chip_select, Transport: As for `fixed::MAX7219`.
+*/
+template <
+    uint8_t num_chips,
+    typename Port, uint8_t mosi, uint8_t clock, uint8_t chip_select,
+    template <typename, uint8_t, uint8_t, uint8_t> class Transport = BitBang>
+class Cascade {
+    static_assert(num_chips > 0, "Need at least one chip");
+
+    public:
+        using Bus = Transport<Port, mosi, clock, chip_select>;
+        static constexpr uint8_t size = num_chips;
+
+        /**
+        Constructor.
+
+        Configure pins for output, and raise chip select.
+        */
+        Cascade() {
+            Bus::init();
+        }
+
+        /**
+        Put every chip into a useful state at start-up.
+
+        See `max7219::MAX7219::init()`.
+        */
+        void init(uint8_t brightness=8) {
+            set_scan_limit(8);
+            use_decode_mode(true);
+            set_brightness(brightness);
+            set_shutdown(false);
+        }
+
+        /**
+        Set brightness of all chips, zero is dim, 15 is bright.
+        */
+        void set_brightness(uint8_t brightness) {
+            brightness = ( brightness > 15) ? 15 : brightness;
+            transmit_all(0x0a, brightness);
+        }
+
+        /**
+        Enable BCD decode mode on all chips.
+        */
+        void use_decode_mode(bool do_decoding) {
+            transmit_all(0x09, do_decoding ? 0xff : 0x00);
+        }
+
+        /**
+        Number of digits to enable on all chips, 1 to 8.
+        */
+        void set_scan_limit(uint8_t limit) {
+            limit = ( limit < 1 ) ? 1 : limit;
+            limit = ( limit > 8 ) ? 8 : limit;
+            transmit_all(0x0b, (limit-1));
+        }
+
+        /**
+        Bring all chips in or out of 'shutdown' (blank display) mode.
+        */
+        void set_shutdown(bool do_shutdown) {
+            transmit_all(0x0c, do_shutdown ? 0x00 : 0x01);
+        }
+
+        /**
+        Turn test mode, all LEDs lit, on or off for all chips.
+        */
+        void set_test_mode(bool do_led_test) {
+            transmit_all(0x0f, do_led_test ? 0x01 : 0x00);
+        }
+
+        /**
+        Set a single digit on a single chip.
+
+        Still costs a whole frame, the other chips are sent no-ops. Prefer
+        `set_row()` when more than one chip is changing.
+
+        Args:
+            chip (uint8_t): Chip to change, zero is nearest the MCU.
+            digit (uint8_t): Digit to set, 0 to 7.
+            data (uint8_t): Value to use for given digit.
+        */
+        void set_digit(uint8_t chip, uint8_t digit, uint8_t data) {
+            digit = ( digit > 7 ) ? 7 : digit;
+            transmit(chip, digit + 1, data);
+        }
+
+        /**
+        Set the same digit on every chip, in a single frame.
+
+        Args:
+            digit (uint8_t): Digit to set, 0 to 7.
+            data (const uint8_t*): One value per chip, `size` in all.
+        */
+        void set_row(uint8_t digit, const uint8_t* data) {
+            digit = ( digit > 7 ) ? 7 : digit;
+            transmit_row(digit + 1, data);
+        }
+
+        /**
+        Set every digit on every chip, in eight frames.
+
+        Args:
+            data: Eight digits for each chip, chip by chip.
+        */
+        void set_digits(const uint8_t data[][8]) {
+            for (uint8_t digit = 0; digit < 8; ++digit) {
+                Bus::select();
+                for (uint8_t chip = num_chips; chip-- > 0; ) {
+                    Bus::send(digit + 1);
+                    Bus::send(data[chip][digit]);
+                }
+                Bus::deselect();
+            }
+        }
+
+        /**
+        Send one command to one chip, and no-ops to all the others.
+        */
+        void transmit(uint8_t chip, const uint8_t address, const uint8_t body) {
+            Bus::select();
+            for (uint8_t i = num_chips; i-- > 0; ) {
+                if ( i == chip ) {
+                    Bus::send(address);
+                    Bus::send(body);
+                } else {
+                    Bus::send(0x00);
+                    Bus::send(0x00);
+                }
+            }
+            Bus::deselect();
+        }
+
+        /**
+        Send the same command to every chip.
+        */
+        void transmit_all(const uint8_t address, const uint8_t body) {
+            Bus::select();
+            for (uint8_t i = num_chips; i > 0; --i) {
+                Bus::send(address);
+                Bus::send(body);
+            }
+            Bus::deselect();
+        }
+
+        /**
+        Send the same register with a different body to every chip.
+
+        Args:
+            address (uint8_t): Register address.
+            bodies (const uint8_t*): One body per chip, `size` in all.
+        */
+        void transmit_row(const uint8_t address, const uint8_t* bodies) {
+            Bus::select();
+            for (uint8_t chip = num_chips; chip-- > 0; ) {
+                Bus::send(address);
+                Bus::send(bodies[chip]);
+            }
+            Bus::deselect();
+        }
+};
+
+
+} // namespace fixed
+
+
+} // namespace max7219
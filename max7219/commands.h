@@ -0,0 +1,148 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "format.h"
+
+
+namespace max7219 {
+
+
+/**
+The chip's commands, in terms of a single ``transmit(address, body)``.
+
+Mixed into the compile-time drivers so that they need only provide how to
+send a command, not what to send::
+
+    class Driver : public Commands<Driver> {
+        public:
+            void transmit(const uint8_t address, const uint8_t body);
+    };
+
+See `max7219::MAX7219` for the full documentation of each command.
+*/
+template <typename Derived>
+class Commands {
+    public:
+        /**
+        Put the chip into a useful state at start-up.
+
+        All digits are enabled, decode-mode is on, brightness is set, device
+        is enabled.
+        */
+        void init(uint8_t brightness=8) {
+            set_scan_limit(8);
+            use_decode_mode(true);
+            set_brightness(brightness);
+            set_shutdown(false);
+        }
+
+        /**
+        Set brightness of entire display, zero is dim, 15 is bright.
+        */
+        void set_brightness(uint8_t brightness) {
+            brightness = ( brightness > 15) ? 15 : brightness;
+            send(0x0a, brightness);
+        }
+
+        /**
+        Enable chips BCD decode mode for use with 7-segment displays.
+        */
+        void use_decode_mode(bool do_decoding) {
+            send(0x09, do_decoding ? 0xff : 0x00);
+        }
+
+        /**
+        Set the value of the given digit, 0 to 7.
+        */
+        void set_digit(uint8_t digit, uint8_t data) {
+            digit = ( digit > 7 ) ? 7 : digit;
+            send(digit + 1, data);
+        }
+
+        /**
+        Number of digits to enable, 1 to 8.
+        */
+        void set_scan_limit(uint8_t limit) {
+            limit = ( limit < 1 ) ? 1 : limit;
+            limit = ( limit > 8 ) ? 8 : limit;
+            send(0x0b, (limit-1));
+        }
+
+        /**
+        Bring the chip in or out of 'shutdown' (blank display) mode.
+        */
+        void set_shutdown(bool do_shutdown) {
+            send(0x0c, do_shutdown ? 0x00 : 0x01);
+        }
+
+        /**
+        Turn test mode, all LEDs lit, on or off.
+        */
+        void set_test_mode(bool do_led_test) {
+            send(0x0f, do_led_test ? 0x01 : 0x00);
+        }
+
+        /**
+        Show unsigned decimal number, 0 to 99,999,999, using decode mode.
+
+        Uses `format::decimal()`, so no division is done. Digit zero is the
+        least-significant. Hyphens are shown on overflow.
+
+        Returns:
+            bool: False on overflow.
+        */
+        bool display_uint32(uint32_t value, bool leading_blank=true) {
+            uint8_t digits[format::num_digits];
+            const bool fits = format::decimal(value, digits, leading_blank);
+            show(digits, true);
+            return fits;
+        }
+
+        /**
+        Show signed decimal number, -9,999,999 to 99,999,999.
+        */
+        bool display_int(int32_t value, bool leading_blank=true) {
+            uint8_t digits[format::num_digits];
+            const bool fits = format::signed_decimal(value, digits, leading_blank);
+            show(digits, true);
+            return fits;
+        }
+
+        /**
+        Show fixed-point number, eg. ``display_fixed(-1234, 2)`` for "-12.34".
+        */
+        bool display_fixed(int32_t value, uint8_t decimals, bool leading_blank=true) {
+            uint8_t digits[format::num_digits];
+            const bool fits = format::fixed_point(value, decimals, digits, leading_blank);
+            show(digits, true);
+            return fits;
+        }
+
+        /**
+        Show 32-bit number in hex, using raw segments with decode mode off.
+        */
+        void display_hex(uint32_t value, bool leading_blank=true) {
+            uint8_t segments[format::num_digits];
+            format::hexadecimal(value, segments, leading_blank);
+            show(segments, false);
+        }
+
+    private:
+        /**
+        Send all eight digits, after setting decode mode to suit them.
+        */
+        void show(const uint8_t* digits, bool decoded) {
+            use_decode_mode(decoded);
+            for (uint8_t digit = 0; digit < format::num_digits; ++digit) {
+                send(digit + 1, digits[digit]);
+            }
+        }
+
+        void send(const uint8_t address, const uint8_t body) {
+            static_cast<Derived*>(this)->transmit(address, body);
+        }
+};
+
+
+} // namespace max7219
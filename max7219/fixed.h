@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+#include <avr/io.h>
+
+#include "commands.h"
+#include "transport.h"
+
+
+namespace max7219 {
+
+
+namespace fixed {
+
+
+/**
+Driver for the MAX7219 with its pins fixed at compile time.
+
+Same interface as `max7219::MAX7219`, but the port and pin numbers are template
+parameters rather than runtime members::
+
+    auto display = max7219::fixed::MAX7219<max7219::PortB, PB2, PB3, PB4>();
+    display.init();
+
+The runtime class has to build every pin mask with a shift loop, then read,
+modify, and write all of PORTB to change a single bit. Here every pin change is
+one ``sbi`` or ``cbi`` and the 16-bit send is fully unrolled.
+
+Cycle counts, hand-counted from the instruction timings in the datasheet for
+code built with ``-Os`` and the pins used by ``main.cpp``:
+
+    =====================  ==========  ===========  ============
+    Class                  Per bit     transmit()   8 digits
+    =====================  ==========  ===========  ============
+    MAX7219                ~95         ~1550        ~12,400
+    fixed, `BitBang`       ~8          ~135         ~1,080
+    fixed, `HardwareSPI`   2           ~40          ~320
+    =====================  ==========  ===========  ============
+
+At 8MHz a full eight digit update drops from 1.5ms to 135us bit-banged, or 40us
+using the SPI peripheral. The price is a little flash: the unrolled send is
+about 100 bytes per distinct pin combination.
+
+The last template argument chooses the transport, see ``transport.h``. Use the
+SPI peripheral's pins to select it::
+
+    max7219::fixed::MAX7219<max7219::PortB, PB3, PB5, PB2, max7219::HardwareSPI>
+*/
+template <
+    typename Port, uint8_t mosi, uint8_t clock, uint8_t chip_select,
+    template <typename, uint8_t, uint8_t, uint8_t> class Transport = BitBang>
+class MAX7219 : public Commands<MAX7219<Port, mosi, clock, chip_select, Transport>> {
+    public:
+        using Bus = Transport<Port, mosi, clock, chip_select>;
+
+        /**
+        Constructor.
+
+        Configure pins for output, and raise chip select.
+        */
+        MAX7219() {
+            Bus::init();
+        }
+
+        /**
+        Send low-level command to chip.
+
+        Address then body, most-significant bit first, all between a single low
+        pulse on chip select ('Load').
+
+        Args:
+            address (uint8_t): Register address.
+            body (uint8_t): Data to send.
+        */
+        void transmit(const uint8_t address, const uint8_t body) {
+            Bus::select();
+            Bus::send(address);
+            Bus::send(body);
+            Bus::deselect();
+        }
+};
+
+
+} // namespace fixed
+
+
+} // namespace max7219
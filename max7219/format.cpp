@@ -0,0 +1,229 @@
+#include <avr/pgmspace.h>
+
+#include "format.h"
+
+
+namespace max7219 {
+
+
+namespace format {
+
+
+/**
+Segment patterns for hexadecimal digits in no-decode mode.
+
+Bit order is DP, A, B, C, D, E, F, G. Lower-case 'b' and 'd' are used so that
+they may be told apart from '8' and '0'.
+*/
+const uint8_t hex_table[16] PROGMEM = {
+    0x7e, 0x30, 0x6d, 0x79, 0x33, 0x5b, 0x5f, 0x70,     // 0-7
+    0x7f, 0x7b, 0x77, 0x1f, 0x4e, 0x3d, 0x4f, 0x47,     // 8-F
+};
+
+
+/**
+Convert binary to packed BCD using the 'double dabble' algorithm.
+
+The value is shifted, a bit at a time, into the BCD bytes. Before each shift
+any BCD digit of five or more has three added, so that doubling it carries
+correctly into the next digit.
+
+Args:
+    value (uint32_t): Zero to 99,999,999.
+    packed (uint8_t*): Four bytes, two digits per byte. Least-significant
+                       digit is in the low nibble of the first byte.
+
+Returns:
+    bool: False if value needs more than 8 digits.
+*/
+bool to_bcd(uint32_t value, uint8_t* packed) {
+    packed[0] = packed[1] = packed[2] = packed[3] = 0;
+    if ( value > 99999999UL ) {
+        return false;
+    }
+
+    // Skip leading zero bits, they would only shift zeros around
+    uint8_t bits = 32;
+    while ( bits && ! (value & 0x80000000UL) ) {
+        value <<= 1;
+        --bits;
+    }
+
+    // Only bytes holding non-zero digits need adjusting
+    uint8_t used = 1;
+    for (; bits > 0; --bits) {
+        for (uint8_t i = 0; i < used; ++i) {
+            uint8_t byte = packed[i];
+            if ( (byte & 0x0f) >= 0x05 ) {
+                byte += 0x03;
+            }
+            if ( (byte & 0xf0) >= 0x50 ) {
+                byte += 0x30;
+            }
+            packed[i] = byte;
+        }
+
+        uint8_t carry = (value & 0x80000000UL) ? 1 : 0;
+        value <<= 1;
+        for (uint8_t i = 0; i < used; ++i) {
+            const uint8_t byte = packed[i];
+            packed[i] = (byte << 1) | carry;
+            carry = byte >> 7;
+        }
+        if ( carry ) {
+            packed[used++] = carry;
+        }
+    }
+    return true;
+}
+
+
+/**
+Fill every digit with a hyphen, to flag overflow.
+*/
+static bool overflow(uint8_t* digits) {
+    for (uint8_t i = 0; i < num_digits; ++i) {
+        digits[i] = hyphen;
+    }
+    return false;
+}
+
+
+/**
+Shared implementation of the decimal functions.
+
+Args:
+    magnitude (uint32_t): Absolute value of number to display.
+    negative (bool): Show a minus sign.
+    min_digits (uint8_t): Digits to show, even if they are leading zeros.
+    digits (uint8_t*): Output, eight Code B values.
+    leading_blank (bool): Blank leading zeros, or show them.
+*/
+static bool place(
+        uint32_t magnitude, bool negative, uint8_t min_digits,
+        uint8_t* digits, bool leading_blank) {
+    uint8_t packed[4];
+    if ( ! to_bcd(magnitude, packed) ) {
+        return overflow(digits);
+    }
+
+    // Unpack, and find the most-significant non-zero digit
+    uint8_t length = min_digits;
+    for (uint8_t i = 0; i < num_digits; ++i) {
+        const uint8_t byte = packed[i >> 1];
+        const uint8_t digit = (i & 1) ? (byte >> 4) : (byte & 0x0f);
+        digits[i] = digit;
+        if ( digit ) {
+            length = (i + 1 > length) ? (i + 1) : length;
+        }
+    }
+
+    if ( leading_blank ) {
+        for (uint8_t i = length; i < num_digits; ++i) {
+            digits[i] = blank;
+        }
+    } else {
+        length = num_digits - 1;
+    }
+
+    if ( negative ) {
+        if ( length >= num_digits || (! leading_blank && digits[length]) ) {
+            return overflow(digits);
+        }
+        digits[length] = hyphen;
+    }
+    return true;
+}
+
+
+/**
+Unsigned decimal, 0 to 99,999,999.
+
+Args:
+    value (uint32_t): Number to convert.
+    digits (uint8_t*): Output, eight Code B values.
+    leading_blank (bool): Blank leading zeros, or show them.
+
+Returns:
+    bool: False on overflow.
+*/
+bool decimal(uint32_t value, uint8_t* digits, bool leading_blank) {
+    return place(value, false, 1, digits, leading_blank);
+}
+
+
+/**
+Signed decimal, -9,999,999 to 99,999,999.
+
+When leading zeros are blanked the minus sign sits just to the left of the
+number, otherwise it is in the left-most digit.
+*/
+bool signed_decimal(int32_t value, uint8_t* digits, bool leading_blank) {
+    const bool negative = (value < 0);
+    const uint32_t magnitude = negative ? -static_cast<uint32_t>(value) : value;
+    return place(magnitude, negative, 1, digits, leading_blank);
+}
+
+
+/**
+Signed fixed-point decimal.
+
+The number is given as an integer, scaled up by the number of decimal places
+to show. For example, a temperature in hundredths of a degree::
+
+    fixed_point(-1234, 2, digits);  // "  -12.34"
+    fixed_point(5, 2, digits);      // "    0.05"
+
+Args:
+    value (int32_t): Number to display, multiplied by 10^decimals.
+    decimals (uint8_t): Digits after the decimal point, 0 to 7.
+*/
+bool fixed_point(int32_t value, uint8_t decimals, uint8_t* digits, bool leading_blank) {
+    decimals = ( decimals > num_digits - 1 ) ? num_digits - 1 : decimals;
+    const bool negative = (value < 0);
+    const uint32_t magnitude = negative ? -static_cast<uint32_t>(value) : value;
+    if ( ! place(magnitude, negative, decimals + 1, digits, leading_blank) ) {
+        return false;
+    }
+    if ( decimals ) {
+        digits[decimals] |= decimal_point;
+    }
+    return true;
+}
+
+
+/**
+Raw segment pattern for a hex digit, 0 to 15.
+*/
+uint8_t hex_segments(uint8_t nibble) {
+    return pgm_read_byte(&hex_table[nibble & 0x0f]);
+}
+
+
+/**
+Hexadecimal, as raw segment patterns for use with decode mode off.
+
+Code B has no letters A to F, so the segments are looked up in a table in flash.
+
+Args:
+    value (uint32_t): Number to convert.
+    segments (uint8_t*): Output, eight segment patterns.
+    leading_blank (bool): Blank (all segments off) leading zeros.
+*/
+void hexadecimal(uint32_t value, uint8_t* segments, bool leading_blank) {
+    for (uint8_t i = 0; i < num_digits; ++i) {
+        segments[i] = hex_segments(value & 0x0f);
+        value >>= 4;
+        if ( leading_blank && ! value ) {
+            for (++i; i < num_digits; ++i) {
+                segments[i] = 0x00;
+            }
+        }
+    }
+}
+
+
+} // namespace format
+
+
+} // namespace max7219
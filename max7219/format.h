@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+
+
+namespace max7219 {
+
+
+/**
+Convert numbers into digits for a seven-segment display, without division.
+
+Dividing by ten is a library call on the AVR, a 32-bit ``%`` and ``/`` about
+650 cycles each time. Instead binary is converted to BCD by 'double dabble'
+(shift-and-add-3), using only shifts, compares, and additions on bytes. About
+1800 cycles for an 8 digit number, under 1000 for small ones, against more than
+5000 using division.
+
+Digits are filled from zero, the least-significant (right-most) digit.
+
+The decimal functions produce 'Code B' values, for use with decode mode on.
+On overflow, when the number will not fit, every digit is set to a hyphen and
+false is returned.
+*/
+namespace format {
+    constexpr uint8_t num_digits = 8;
+
+    /// Code B values
+    constexpr uint8_t hyphen = 0x0a;
+    constexpr uint8_t blank = 0x0f;
+
+    /// Decimal-point, OR'd with digit in both decode and no-decode modes
+    constexpr uint8_t decimal_point = 0x80;
+
+    bool decimal(uint32_t value, uint8_t* digits, bool leading_blank=true);
+    bool signed_decimal(int32_t value, uint8_t* digits, bool leading_blank=true);
+    bool fixed_point(
+        int32_t value, uint8_t decimals, uint8_t* digits, bool leading_blank=true);
+    void hexadecimal(uint32_t value, uint8_t* segments, bool leading_blank=true);
+    uint8_t hex_segments(uint8_t nibble);
+    bool to_bcd(uint32_t value, uint8_t* packed);
+} // namespace format
+
+
+} // namespace max7219
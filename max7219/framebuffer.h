@@ -0,0 +1,183 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "cascade.h"
+
+
+namespace max7219 {
+
+
+namespace fixed {
+
+
+/**
+RAM shadow of the digit registers of a chain of chips.
+
+Drawing only changes RAM, nothing is sent until `flush()`. Then only the rows
+that have actually changed since the last flush are transmitted, one frame per
+row, with chips whose row is unchanged sent a no-op. Writing a value that a digit
+already holds costs nothing at all. (A digit changed and then changed back
+before the flush is still sent.)::
+
+    auto chain = max7219::fixed::Cascade<4, max7219::PortB, PB2, PB3, PB4>();
+    auto buffer = max7219::fixed::Framebuffer<decltype(chain)>();
+    chain.init();
+    buffer.flush();     // Everything starts dirty, so this clears the display
+    buffer.set_digit(2, 5, 0b00111100);
+    buffer.flush();     // One frame
+
+Costs 9 bytes of RAM per chip, plus one.
+
+Works for a single chip too, just use a `Cascade` of one.
+
+Args:
+    Chain: Type of the `Cascade` driving the chips.
+*/
+template <typename Chain>
+class Framebuffer {
+    public:
+        static constexpr uint8_t size = Chain::size;
+
+    private:
+        using Bus = typename Chain::Bus;
+        uint8_t digits[size][8];
+        uint8_t dirty[size];        // One bit per digit, per chip
+        uint8_t dirty_rows;         // One bit per digit, set if dirty on any chip
+
+    public:
+        /**
+        Constructor.
+
+        The buffer starts cleared, with every row marked dirty, as the state of
+        the chips' registers after power-up is undefined.
+        */
+        Framebuffer() {
+            for (uint8_t chip = 0; chip < size; ++chip) {
+                for (uint8_t digit = 0; digit < 8; ++digit) {
+                    digits[chip][digit] = 0x00;
+                }
+            }
+            invalidate();
+        }
+
+        /**
+        Set every digit on every chip to zero.
+        */
+        void clear() {
+            fill(0x00);
+        }
+
+        /**
+        Set every digit on every chip to the given value.
+        */
+        void fill(uint8_t data) {
+            for (uint8_t chip = 0; chip < size; ++chip) {
+                for (uint8_t digit = 0; digit < 8; ++digit) {
+                    set_digit(chip, digit, data);
+                }
+            }
+        }
+
+        /**
+        Read back digit from shadow.
+        */
+        uint8_t get_digit(uint8_t chip, uint8_t digit) const {
+            return digits[chip][digit & 0x07];
+        }
+
+        /**
+        Change digit in shadow, marking it dirty only if its value changes.
+
+        Args:
+            chip (uint8_t): Chip to change, zero is nearest the MCU.
+            digit (uint8_t): Digit to set, 0 to 7.
+            data (uint8_t): New value for given digit.
+        */
+        void set_digit(uint8_t chip, uint8_t digit, uint8_t data) {
+            digit &= 0x07;
+            if ( digits[chip][digit] != data ) {
+                digits[chip][digit] = data;
+                dirty[chip] |= (1 << digit);
+                dirty_rows |= (1 << digit);
+            }
+        }
+
+        /**
+        Direct access to the eight digits of a chip.
+
+        Call `touch()` for any digit changed this way.
+        */
+        uint8_t* row(uint8_t chip) {
+            return digits[chip];
+        }
+
+        /**
+        Mark a digit as dirty, whatever its value.
+        */
+        void touch(uint8_t chip, uint8_t digit) {
+            dirty[chip] |= (1 << (digit & 0x07));
+            dirty_rows |= (1 << (digit & 0x07));
+        }
+
+        /**
+        Mark everything as dirty.
+
+        Use after anything that might have changed the chips behind our back,
+        like `Cascade::init()` or a glitch on the power supply.
+        */
+        void invalidate() {
+            for (uint8_t chip = 0; chip < size; ++chip) {
+                dirty[chip] = 0xff;
+            }
+            dirty_rows = 0xff;
+        }
+
+        /**
+        True if there is anything waiting for `flush()`.
+        */
+        bool is_dirty() const {
+            return dirty_rows;
+        }
+
+        /**
+        Transmit every changed digit, and only the changed digits.
+
+        Returns:
+            uint8_t: Number of frames sent, zero to eight.
+        */
+        uint8_t flush() {
+            uint8_t frames = 0;
+            for (uint8_t digit = 0; digit < 8; ++digit) {
+                const uint8_t mask = (1 << digit);
+                if ( dirty_rows & mask ) {
+                    flush_row(digit, mask);
+                    ++frames;
+                }
+            }
+            dirty_rows = 0;
+            return frames;
+        }
+
+    private:
+        void flush_row(uint8_t digit, uint8_t mask) {
+            Bus::select();
+            for (uint8_t chip = size; chip-- > 0; ) {
+                if ( dirty[chip] & mask ) {
+                    Bus::send(digit + 1);
+                    Bus::send(digits[chip][digit]);
+                    dirty[chip] &= ~mask;
+                } else {
+                    Bus::send(0x00);
+                    Bus::send(0x00);
+                }
+            }
+            Bus::deselect();
+        }
+};
+
+
+} // namespace fixed
+
+
+} // namespace max7219
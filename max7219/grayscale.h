@@ -0,0 +1,214 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "cascade.h"
+
+
+namespace max7219 {
+
+
+namespace fixed {
+
+
+/**
+Per-pixel grayscale on 8x8 LED matrix modules, by bit-plane modulation.
+
+The chip itself only has on/off pixels and a single global brightness. Here
+each pixel gets a `bits` wide intensity, stored as `bits` separate bit-planes.
+A timer interrupt cycles through the planes, showing plane ``b`` for ``2^b``
+time slots. A pixel of level 5 (binary 101) is lit for 1 + 4 = 5 slots out of 7.
+
+Layout matches `Matrix`: chip zero on the left, digit registers are rows, and
+bit 7 is the left-most column. Decode mode must be off::
+
+    auto chain = max7219::fixed::Cascade<4, max7219::PortB, PB2, PB3, PB4>();
+    auto gray = max7219::fixed::Grayscale<decltype(chain), 2>();
+
+    ISR(TIMER2_COMPA_vect) {
+        gray.tick();
+    }
+
+    chain.init();
+    chain.use_decode_mode(false);
+    gray.set_pixel(3, 4, 2);
+
+Program a timer to call `tick()` every `slot_cycles()` CPU cycles.
+
+Equal time slots with different global intensities per plane would refresh
+faster, but the chip's duty-cycle steps are (2n+1)/32 and cannot give the
+exact 1:2:4 weights that make the levels evenly spaced.
+
+Budget
+======
+
+Each plane change resends the whole chain: eight frames of ``size`` words.
+That happens inside the ISR, so it's long: other interrupts wait. The plane's
+slot must be longer than that to leave the main loop any time, hence the
+`load_percent` argument of the budget functions.
+
+Also, the chip scans its eight digits at about 800Hz. A slot shorter than one
+scan (1.25ms) would leave some rows never lit during the plane, so that is the
+shortest useful slot, which caps refresh at about 266Hz for 2 bits and 114Hz
+for 3.
+
+Refresh rate in Hz with the CPU half-loaded, as set by sending alone, before
+the scan rate cap. `refresh_hz()` gives the lower of this and the cap:
+
+    ======  ======  =========  =========  ==========  ==========
+    Chips   Bits    BitBang    BitBang    HardwareSPI HardwareSPI
+                    8MHz       16MHz      8MHz        16MHz
+    ======  ======  =========  =========  ==========  ==========
+    1       2       1149       2298       3333        6666
+    4       2       303        606        980         1960
+    8       2       152        305        505         1010
+    16      2       76         153        256         512
+    1       3       492        985        1428        2857
+    4       3       129        259        420         840
+    8       3       65         131        216         432
+    16      3       32         65         109         219
+    ======  ======  =========  =========  ==========  ==========
+
+Anything under 100Hz will flicker. Drawing while the ISR is sending may show a
+half-updated pixel for one refresh.
+
+Args:
+    Chain: Type of the `Cascade` driving the modules.
+    bits: Bits of intensity per pixel, 1 to 3.
+*/
+template <typename Chain, uint8_t bits = 2>
+class Grayscale {
+    static_assert(bits >= 1 && bits <= 3, "Between 1 and 3 bits per pixel");
+
+    public:
+        using Bus = typename Chain::Bus;
+        static constexpr uint8_t size = Chain::size;
+        static constexpr uint16_t width = 8 * static_cast<uint16_t>(size);
+        static constexpr uint8_t height = 8;
+        static constexpr uint8_t max_level = (1 << bits) - 1;
+
+        /// Chip's digit scan period, the shortest useful time slot
+        static constexpr uint32_t scan_period_us = 1250;
+
+        /**
+        CPU cycles to send one bit-plane to the whole chain.
+        */
+        static constexpr uint32_t plane_cycles() {
+            return 8 * (static_cast<uint32_t>(size) * Bus::cycles_per_word + 10);
+        }
+
+        /**
+        CPU cycles per time slot, so that sending uses the given CPU share.
+
+        Never shorter than the chip's own scan period. The share is limited
+        to 1 to 100 percent.
+        */
+        static constexpr uint32_t slot_cycles(uint8_t load_percent=50) {
+            const uint8_t load = (load_percent < 1) ? 1 :
+                (load_percent > 100) ? 100 : load_percent;
+            const uint32_t sending = plane_cycles() * 100 / load;
+            const uint32_t scan = (F_CPU / 1000) * scan_period_us / 1000;
+            return (sending > scan) ? sending : scan;
+        }
+
+        /**
+        Full grayscale refreshes per second, for the given CPU share.
+        */
+        static constexpr uint32_t refresh_hz(uint8_t load_percent=50) {
+            return F_CPU / (slot_cycles(load_percent) * max_level);
+        }
+
+    private:
+        uint8_t planes[bits][size][8];
+        volatile uint8_t plane = bits - 1;
+        volatile uint8_t remaining = 1;
+
+        void send_plane(uint8_t index) {
+            for (uint8_t digit = 0; digit < 8; ++digit) {
+                Bus::select();
+                for (uint8_t chip = size; chip-- > 0; ) {
+                    Bus::send(digit + 1);
+                    Bus::send(planes[index][chip][digit]);
+                }
+                Bus::deselect();
+            }
+        }
+
+    public:
+        Grayscale() {
+            clear();
+        }
+
+        /**
+        Set every pixel to level zero.
+        */
+        void clear() {
+            for (uint8_t b = 0; b < bits; ++b) {
+                for (uint8_t chip = 0; chip < size; ++chip) {
+                    for (uint8_t digit = 0; digit < 8; ++digit) {
+                        planes[b][chip][digit] = 0x00;
+                    }
+                }
+            }
+        }
+
+        /**
+        Level of pixel, zero to `max_level`. Pixels off the canvas are zero.
+        */
+        uint8_t get_pixel(uint16_t x, uint8_t y) const {
+            if ( x >= width || y >= height ) {
+                return 0;
+            }
+            const uint8_t chip = x >> 3;
+            const uint8_t mask = (0x80 >> (x & 0x07));
+            uint8_t level = 0;
+            for (uint8_t b = 0; b < bits; ++b) {
+                if ( planes[b][chip][y] & mask ) {
+                    level |= (1 << b);
+                }
+            }
+            return level;
+        }
+
+        /**
+        Set level of pixel, zero (off) to `max_level` (fully on).
+
+        Larger levels are clamped. Pixels off the canvas are ignored.
+        */
+        void set_pixel(uint16_t x, uint8_t y, uint8_t level) {
+            if ( x >= width || y >= height ) {
+                return;
+            }
+            level = ( level > max_level ) ? max_level : level;
+            const uint8_t chip = x >> 3;
+            const uint8_t mask = (0x80 >> (x & 0x07));
+            for (uint8_t b = 0; b < bits; ++b) {
+                if ( level & (1 << b) ) {
+                    planes[b][chip][y] |= mask;
+                } else {
+                    planes[b][chip][y] &= ~mask;
+                }
+            }
+        }
+
+        /**
+        Advance one time slot. Call from timer ISR only.
+
+        Cheap except when it is time to change planes, when the whole chain is
+        sent: see `plane_cycles()`.
+        */
+        void tick() {
+            if ( --remaining ) {
+                return;
+            }
+            plane = ( plane + 1 == bits ) ? 0 : plane + 1;
+            remaining = (1 << plane);
+            send_plane(plane);
+        }
+};
+
+
+} // namespace fixed
+
+
+} // namespace max7219
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <avr/io.h>
+
+
+/**
+Host stand-in for avr-libc's <avr/interrupt.h>.
+
+There are no interrupts on the host: handlers are plain functions, called
+directly by the code under test.
+*/
+#define ISR(vector)     extern "C" void vector(void)
+
+inline void cli() {}
+inline void sei() {}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "../registers.h"
+
+
+/**
+Host stand-in for avr-libc's <avr/io.h>, ATmega328P subset.
+
+Each register is a `host::Register`, which behaves like a ``uint8_t`` but counts
+accesses and can call a hook on every write.
+*/
+extern host::Register PINB, DDRB, PORTB;
+extern host::Register PINC, DDRC, PORTC;
+extern host::Register PIND, DDRD, PORTD;
+extern host::Register SPCR, SPSR, SPDR;
+
+
+#define PB0     0
+#define PB1     1
+#define PB2     2
+#define PB3     3
+#define PB4     4
+#define PB5     5
+#define PB6     6
+#define PB7     7
+
+#define PC0     0
+#define PC1     1
+#define PC2     2
+#define PC3     3
+#define PC4     4
+#define PC5     5
+#define PC6     6
+
+#define PD0     0
+#define PD1     1
+#define PD2     2
+#define PD3     3
+#define PD4     4
+#define PD5     5
+#define PD6     6
+#define PD7     7
+
+// SPCR
+#define SPR0    0
+#define SPR1    1
+#define CPHA    2
+#define CPOL    3
+#define MSTR    4
+#define DORD    5
+#define SPE     6
+#define SPIE    7
+
+// SPSR
+#define SPI2X   0
+#define WCOL    6
+#define SPIF    7
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdint.h>
+
+
+/**
+Host stand-in for avr-libc's <avr/pgmspace.h>. Flash is just memory.
+*/
+#define PROGMEM
+#define pgm_read_byte(address)  (*reinterpret_cast<const uint8_t*>(address))
+#define pgm_read_word(address)  (*reinterpret_cast<const uint16_t*>(address))
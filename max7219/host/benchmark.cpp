@@ -0,0 +1,265 @@
+/**
+Host-side protocol check and throughput benchmark for the MAX7219 drivers.
+
+Runs the real driver code against mocked registers, with a chain of virtual
+chips decoding the pin transitions back into register values. Every scenario
+checks that the chips end up holding what was sent, then reports what it
+cost: load pulses, clock edges, register writes, and estimated AVR cycles.
+
+The cycle estimates come from a per-driver cost model, hand-counted from the
+datasheet's instruction timings, applied to the counted register accesses:
+
+    Runtime `MAX7219`
+        25 cycles per port write (mask built by shift loop, then read-modify-
+        write), plus 20 per bit for the loop and testing the data bit.
+
+    `BitBang`
+        2 cycles per port write (``sbi`` or ``cbi``), plus 2 per bit to test
+        the data bit.
+
+    `HardwareSPI`
+        18 cycles per byte written to ``SPDR`` (16 on the wire at F_CPU/2,
+        plus polling ``SPIF``), and 2 per port write for chip select.
+
+The counts are exact; the cycles are only as good as the model. Watch both for
+regressions. Exits with status 1 if any chip ends up in the wrong state.
+*/
+
+#include <cstdio>
+
+#include <avr/io.h>
+
+#include "../cascade.h"
+#include "../fixed.h"
+#include "../framebuffer.h"
+#include "../max7219.h"
+#include "../refresh.h"
+#include "simulator.h"
+
+
+using host::VirtualChain;
+
+
+struct Model {
+    const char* name;
+    uint32_t per_port_write;
+    uint32_t per_bit;
+    uint32_t per_spi_byte;
+};
+
+const Model runtime_model = {"runtime", 25, 20, 0};
+const Model bitbang_model = {"BitBang", 2, 2, 0};
+const Model spi_model = {"HardwareSPI", 2, 0, 18};
+
+int failures = 0;
+
+
+void reset_counts(VirtualChain& chain) {
+    chain.reset_counts();
+    PORTB.reset_counts();
+    SPDR.reset_counts();
+}
+
+
+/**
+Every digit of every chip, set from its position.
+*/
+uint8_t pattern(uint8_t chip, uint8_t digit) {
+    return (chip * 8 + digit) ^ 0xa5;
+}
+
+
+void check(VirtualChain& chain, const char* scenario) {
+    for (uint8_t chip = 0; chip < chain.size(); ++chip) {
+        for (uint8_t digit = 0; digit < 8; ++digit) {
+            const uint8_t found = chain.chip(chip).digits[digit];
+            const uint8_t expected = pattern(chip, digit);
+            if ( found != expected ) {
+                printf("FAIL %s: chip %d digit %d is 0x%02x, expected 0x%02x\n",
+                    scenario, chip, digit, found, expected);
+                ++failures;
+                return;
+            }
+        }
+    }
+}
+
+
+void report(const char* scenario, const Model& model, VirtualChain& chain) {
+    const uint32_t cycles =
+        PORTB.writes * model.per_port_write +
+        chain.clock_edges * model.per_bit +
+        SPDR.writes * model.per_spi_byte;
+    const uint32_t per_frame = chain.latches ? cycles / chain.latches : 0;
+    printf("%-22s %-12s %6d %7u %8u %7u %6u %9u %9u\n",
+        scenario, model.name, chain.size(), chain.latches, chain.clock_edges,
+        PORTB.writes, SPDR.writes, cycles, per_frame);
+}
+
+
+/**
+Full update of one chip using the original runtime-pin class.
+*/
+void bench_runtime() {
+    VirtualChain chain(1, PB2, PB3, PB4);
+    auto display = max7219::MAX7219(PB2, PB3, PB4);
+    reset_counts(chain);
+    for (uint8_t digit = 0; digit < 8; ++digit) {
+        display.set_digit(digit, pattern(0, digit));
+    }
+    check(chain, "MAX7219");
+    report("MAX7219, 8 digits", runtime_model, chain);
+}
+
+
+/**
+Full update of one chip using the compile-time class.
+*/
+template <
+    uint8_t mosi, uint8_t clock, uint8_t chip_select,
+    template <typename, uint8_t, uint8_t, uint8_t> class Transport>
+void bench_fixed(const Model& model) {
+    VirtualChain chain(1, mosi, clock, chip_select);
+    auto display = max7219::fixed::MAX7219<
+        max7219::PortB, mosi, clock, chip_select, Transport>();
+    reset_counts(chain);
+    for (uint8_t digit = 0; digit < 8; ++digit) {
+        display.set_digit(digit, pattern(0, digit));
+    }
+    check(chain, "fixed::MAX7219");
+    report("fixed, 8 digits", model, chain);
+}
+
+
+/**
+Full update of a whole chain, using both the batched and the naive approach.
+*/
+template <
+    uint8_t chips, uint8_t mosi, uint8_t clock, uint8_t chip_select,
+    template <typename, uint8_t, uint8_t, uint8_t> class Transport>
+void bench_cascade(const Model& model) {
+    VirtualChain chain(chips, mosi, clock, chip_select);
+    auto cascade = max7219::fixed::Cascade<
+        chips, max7219::PortB, mosi, clock, chip_select, Transport>();
+
+    uint8_t data[chips][8];
+    for (uint8_t chip = 0; chip < chips; ++chip) {
+        for (uint8_t digit = 0; digit < 8; ++digit) {
+            data[chip][digit] = pattern(chip, digit);
+        }
+    }
+
+    reset_counts(chain);
+    cascade.set_digits(data);
+    check(chain, "Cascade::set_digits");
+    report("Cascade::set_digits", model, chain);
+
+    // Forget what set_digits() left behind, so only set_digit() can pass
+    for (uint8_t chip = 0; chip < chips; ++chip) {
+        chain.chip(chip) = host::Chip();
+    }
+    reset_counts(chain);
+    for (uint8_t chip = 0; chip < chips; ++chip) {
+        for (uint8_t digit = 0; digit < 8; ++digit) {
+            cascade.set_digit(chip, digit, pattern(chip, digit));
+        }
+    }
+    check(chain, "Cascade::set_digit");
+    report("Cascade::set_digit", model, chain);
+
+    // Shadowed: first flush sends everything, a one digit change sends one row
+    auto buffer = max7219::fixed::Framebuffer<decltype(cascade)>();
+    for (uint8_t chip = 0; chip < chips; ++chip) {
+        for (uint8_t digit = 0; digit < 8; ++digit) {
+            buffer.set_digit(chip, digit, pattern(chip, digit));
+        }
+    }
+    buffer.flush();
+    buffer.set_digit(chips - 1, 3, pattern(chips - 1, 3));     // No change
+    buffer.set_digit(0, 5, pattern(0, 5) ^ 0xff);
+    reset_counts(chain);
+    buffer.flush();
+    if ( chain.latches != 1 || chain.chip(0).digits[5] != (pattern(0, 5) ^ 0xff) ) {
+        printf("FAIL Framebuffer::flush: %u frames sent, expected 1\n", chain.latches);
+        ++failures;
+    }
+    report("Framebuffer, 1 digit", model, chain);
+}
+
+
+/**
+Corrupt every register of every chip, then let the refresher repair them.
+*/
+template <
+    uint8_t chips, uint8_t mosi, uint8_t clock, uint8_t chip_select,
+    template <typename, uint8_t, uint8_t, uint8_t> class Transport>
+void bench_refresh(const Model& model) {
+    VirtualChain chain(chips, mosi, clock, chip_select);
+    auto cascade = max7219::fixed::Cascade<
+        chips, max7219::PortB, mosi, clock, chip_select, Transport>();
+    auto buffer = max7219::fixed::Framebuffer<decltype(cascade)>();
+    auto refresher = max7219::fixed::Refresher<decltype(cascade)>(cascade, buffer, 2);
+    for (uint8_t chip = 0; chip < chips; ++chip) {
+        for (uint8_t digit = 0; digit < 8; ++digit) {
+            buffer.set_digit(chip, digit, pattern(chip, digit));
+        }
+    }
+    refresher.init(5);
+
+    for (uint8_t chip = 0; chip < chips; ++chip) {
+        host::Chip& corrupt = chain.chip(chip);
+        corrupt = host::Chip();
+        corrupt.test = 1;
+    }
+
+    reset_counts(chain);
+    for (uint8_t i = 0; i < 2 * 13; ++i) {
+        refresher.tick();
+        refresher.service();
+    }
+    check(chain, "Refresher");
+    for (uint8_t chip = 0; chip < chips; ++chip) {
+        const host::Chip& repaired = chain.chip(chip);
+        if ( repaired.shutdown != 1 || repaired.scan_limit != 7 ||
+                repaired.intensity != 5 || repaired.test != 0 ) {
+            printf("FAIL Refresher: chip %d settings not restored\n", chip);
+            ++failures;
+            break;
+        }
+    }
+    if ( chain.latches != 13 ) {
+        printf("FAIL Refresher: %u frames sent, expected 13\n", chain.latches);
+        ++failures;
+    }
+    report("Refresher, full pass", model, chain);
+}
+
+
+int main() {
+    printf("%-22s %-12s %6s %7s %8s %7s %6s %9s %9s\n",
+        "Scenario", "Transport", "Chips", "Frames", "Edges",
+        "Port", "SPDR", "Cycles", "/frame");
+
+    bench_runtime();
+    bench_fixed<PB2, PB3, PB4, max7219::BitBang>(bitbang_model);
+    bench_fixed<PB3, PB5, PB2, max7219::HardwareSPI>(spi_model);
+
+    bench_cascade<1, PB2, PB3, PB4, max7219::BitBang>(bitbang_model);
+    bench_cascade<4, PB2, PB3, PB4, max7219::BitBang>(bitbang_model);
+    bench_cascade<8, PB2, PB3, PB4, max7219::BitBang>(bitbang_model);
+    bench_cascade<16, PB2, PB3, PB4, max7219::BitBang>(bitbang_model);
+    bench_cascade<1, PB3, PB5, PB2, max7219::HardwareSPI>(spi_model);
+    bench_cascade<4, PB3, PB5, PB2, max7219::HardwareSPI>(spi_model);
+    bench_cascade<8, PB3, PB5, PB2, max7219::HardwareSPI>(spi_model);
+    bench_cascade<16, PB3, PB5, PB2, max7219::HardwareSPI>(spi_model);
+
+    bench_refresh<4, PB2, PB3, PB4, max7219::BitBang>(bitbang_model);
+    bench_refresh<4, PB3, PB5, PB2, max7219::HardwareSPI>(spi_model);
+
+    if ( failures ) {
+        printf("\n%d FAILED\n", failures);
+        return 1;
+    }
+    printf("\nAll chips decoded correctly.\n");
+    return 0;
+}
@@ -0,0 +1,224 @@
+/**
+Host-side check of the number formatting in ``format.cpp``.
+
+Every result is rendered back into the text the display would show, left-most
+digit first, with a ``.`` after any digit that has its decimal point lit, and
+compared with the expected text:
+
+    Double dabble
+        `to_bcd` against ``printf`` for the boundaries and a spread of values,
+        and the overflow just past 99,999,999.
+
+    Placement
+        `decimal`, `signed_decimal` and `fixed_point`, with and without leading
+        blanks: where the minus sign and decimal point land, and what overflows.
+
+    Hexadecimal
+        The segment table against patterns built from the segment letters of
+        each character, then `hexadecimal` against ``printf``.
+
+Exits with status 1 on any mismatch.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "../format.h"
+
+
+namespace format = max7219::format;
+
+int failures = 0;
+
+
+/**
+Text shown by eight Code B digits.
+*/
+std::string render(const uint8_t* digits) {
+    std::string text;
+    for (int i = format::num_digits - 1; i >= 0; --i) {
+        const uint8_t code = digits[i] & ~format::decimal_point;
+        if ( code <= 9 ) {
+            text += static_cast<char>('0' + code);
+        } else if ( code == format::hyphen ) {
+            text += '-';
+        } else if ( code == format::blank ) {
+            text += ' ';
+        } else {
+            text += '?';
+        }
+        if ( digits[i] & format::decimal_point ) {
+            text += '.';
+        }
+    }
+    return text;
+}
+
+
+void expect(const char* call, bool ok, const uint8_t* digits, bool expected_ok, const char* expected) {
+    const std::string text = render(digits);
+    if ( ok != expected_ok || text != expected ) {
+        printf("FAIL %s: \"%s\" (%s), expected \"%s\" (%s)\n",
+            call, text.c_str(), ok ? "true" : "false",
+            expected, expected_ok ? "true" : "false");
+        ++failures;
+    }
+}
+
+
+void check_bcd(uint32_t value) {
+    uint8_t packed[4];
+    const bool ok = format::to_bcd(value, packed);
+    char found[9], expected[9];
+    for (int i = 0; i < 8; ++i) {
+        found[7 - i] = '0' + ((packed[i / 2] >> (4 * (i & 1))) & 0x0f);
+    }
+    found[8] = 0;
+    snprintf(expected, sizeof(expected), "%08u", value);
+    if ( ! ok || strcmp(found, expected) ) {
+        printf("FAIL to_bcd(%u): %s, expected %s\n", value, found, expected);
+        ++failures;
+    }
+}
+
+
+void check_double_dabble() {
+    static const uint32_t values[] = {
+        0, 1, 9, 10, 99, 100, 4095, 65535, 65536, 1234567, 9999999, 10000000,
+        12345678, 87654321, 90909090, 99999999};
+    for (uint32_t value : values) {
+        check_bcd(value);
+    }
+    // A spread across the range, with varied digits in every position
+    for (uint32_t value = 7; value < 100000000; value += 1234567) {
+        check_bcd(value);
+    }
+
+    uint8_t packed[4];
+    if ( format::to_bcd(100000000, packed) || format::to_bcd(0xffffffff, packed) ) {
+        printf("FAIL to_bcd: no overflow above 99,999,999\n");
+        ++failures;
+    }
+}
+
+
+void check_placement() {
+    uint8_t d[format::num_digits];
+    bool ok;
+
+    ok = format::decimal(0, d);
+    expect("decimal(0)", ok, d, true, "       0");
+    ok = format::decimal(1234, d);
+    expect("decimal(1234)", ok, d, true, "    1234");
+    ok = format::decimal(1234, d, false);
+    expect("decimal(1234, false)", ok, d, true, "00001234");
+    ok = format::decimal(99999999, d);
+    expect("decimal(99999999)", ok, d, true, "99999999");
+    ok = format::decimal(100000000, d);
+    expect("decimal(100000000)", ok, d, false, "--------");
+
+    ok = format::signed_decimal(-1, d);
+    expect("signed_decimal(-1)", ok, d, true, "      -1");
+    ok = format::signed_decimal(-1234, d);
+    expect("signed_decimal(-1234)", ok, d, true, "   -1234");
+    ok = format::signed_decimal(-1234, d, false);
+    expect("signed_decimal(-1234, false)", ok, d, true, "-0001234");
+    ok = format::signed_decimal(1234, d, false);
+    expect("signed_decimal(1234, false)", ok, d, true, "00001234");
+    ok = format::signed_decimal(-9999999, d);
+    expect("signed_decimal(-9999999)", ok, d, true, "-9999999");
+    ok = format::signed_decimal(-9999999, d, false);
+    expect("signed_decimal(-9999999, false)", ok, d, true, "-9999999");
+    ok = format::signed_decimal(-10000000, d);
+    expect("signed_decimal(-10000000)", ok, d, false, "--------");
+    ok = format::signed_decimal(-10000000, d, false);
+    expect("signed_decimal(-10000000, false)", ok, d, false, "--------");
+    ok = format::signed_decimal(INT32_MIN, d);
+    expect("signed_decimal(INT32_MIN)", ok, d, false, "--------");
+    ok = format::signed_decimal(99999999, d);
+    expect("signed_decimal(99999999)", ok, d, true, "99999999");
+
+    ok = format::fixed_point(-1234, 2, d);
+    expect("fixed_point(-1234, 2)", ok, d, true, "   -12.34");
+    ok = format::fixed_point(5, 2, d);
+    expect("fixed_point(5, 2)", ok, d, true, "     0.05");
+    ok = format::fixed_point(-5, 2, d);
+    expect("fixed_point(-5, 2)", ok, d, true, "    -0.05");
+    ok = format::fixed_point(-5, 2, d, false);
+    expect("fixed_point(-5, 2, false)", ok, d, true, "-00000.05");
+    ok = format::fixed_point(0, 0, d);
+    expect("fixed_point(0, 0)", ok, d, true, "       0");
+    ok = format::fixed_point(1234567, 7, d);
+    expect("fixed_point(1234567, 7)", ok, d, true, "0.1234567");
+    ok = format::fixed_point(-1234567, 7, d);
+    expect("fixed_point(-1234567, 7)", ok, d, false, "--------");
+    ok = format::fixed_point(-9999999, 3, d);
+    expect("fixed_point(-9999999, 3)", ok, d, true, "-9999.999");
+    ok = format::fixed_point(123, 9, d);
+    expect("fixed_point(123, 9)", ok, d, true, "0.0000123");
+}
+
+
+/**
+Segment pattern from segment letters, bit 6 for A down to bit 0 for G.
+*/
+uint8_t segments_of(const char* letters) {
+    uint8_t pattern = 0;
+    for (const char* letter = letters; *letter; ++letter) {
+        pattern |= 0x40 >> (*letter - 'A');
+    }
+    return pattern;
+}
+
+
+void check_hexadecimal() {
+    static const char* const letters[16] = {
+        "ABCDEF", "BC", "ABDEG", "ABCDG", "BCFG", "ACDFG", "ACDEFG", "ABC",
+        "ABCDEFG", "ABCDFG", "ABCEFG", "CDEFG", "ADEF", "BCDEG", "ADEFG", "AEFG"};
+    uint8_t table[16];
+    for (uint8_t nibble = 0; nibble < 16; ++nibble) {
+        table[nibble] = segments_of(letters[nibble]);
+        const uint8_t found = format::hex_segments(nibble);
+        if ( found != table[nibble] ) {
+            printf("FAIL hex_segments(%x): 0x%02x, expected 0x%02x\n",
+                nibble, found, table[nibble]);
+            ++failures;
+        }
+    }
+
+    static const uint32_t values[] = {0, 0x1f, 0xabc, 0x12345678, 0xdeadbeef, 0xffffffff};
+    for (uint32_t value : values) {
+        for (bool leading_blank : {true, false}) {
+            char text[9];
+            snprintf(text, sizeof(text), leading_blank ? "%8x" : "%08x", value);
+            uint8_t found[format::num_digits];
+            format::hexadecimal(value, found, leading_blank);
+            for (uint8_t i = 0; i < format::num_digits; ++i) {
+                const char c = text[7 - i];
+                const uint8_t expected = (c == ' ') ? 0x00 :
+                    table[(c <= '9') ? c - '0' : c - 'a' + 10];
+                if ( found[i] != expected ) {
+                    printf("FAIL hexadecimal(0x%x, %d): digit %d is 0x%02x, expected 0x%02x\n",
+                        value, leading_blank, i, found[i], expected);
+                    ++failures;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+
+int main() {
+    check_double_dabble();
+    check_placement();
+    check_hexadecimal();
+
+    if ( failures ) {
+        printf("\n%d FAILED\n", failures);
+        return 1;
+    }
+    printf("All formatting checks passed.\n");
+    return 0;
+}
@@ -0,0 +1,7 @@
+#include <avr/io.h>
+
+
+host::Register PINB, DDRB, PORTB;
+host::Register PINC, DDRC, PORTC;
+host::Register PIND, DDRD, PORTD;
+host::Register SPCR, SPSR, SPDR;
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+
+
+namespace host {
+
+
+/**
+An 8-bit I/O register, for running AVR code on the host.
+
+Reads and writes like a ``uint8_t``, including the compound assignments used
+to set and clear bits. Every write counts as one access, as would one ``out``,
+``sbi``, or ``cbi`` on the chip, and calls the hook (if any) with the old and
+new values.
+*/
+class Register {
+    public:
+        using Hook = std::function<void(uint8_t before, uint8_t after)>;
+
+    private:
+        uint8_t value = 0;
+        Hook hook;
+
+        void write(uint8_t after) {
+            const uint8_t before = value;
+            value = after;
+            ++writes;
+            if ( hook ) {
+                hook(before, after);
+            }
+        }
+
+    public:
+        uint32_t reads = 0;
+        uint32_t writes = 0;
+
+        operator uint8_t() {
+            ++reads;
+            return value;
+        }
+
+        Register& operator=(uint8_t other) {
+            write(other);
+            return *this;
+        }
+
+        Register& operator|=(uint8_t bits) {
+            write(value | bits);
+            return *this;
+        }
+
+        Register& operator&=(uint8_t bits) {
+            write(value & bits);
+            return *this;
+        }
+
+        Register& operator^=(uint8_t bits) {
+            write(value ^ bits);
+            return *this;
+        }
+
+        /**
+        Value without counting a read, for tests.
+        */
+        uint8_t peek() const {
+            return value;
+        }
+
+        /**
+        Value without counting a write or calling the hook, eg. for flags that
+        the hardware sets.
+        */
+        void poke(uint8_t other) {
+            value = other;
+        }
+
+        void set_hook(Hook function) {
+            hook = function;
+        }
+
+        void reset_counts() {
+            reads = writes = 0;
+        }
+};
+
+
+} // namespace host
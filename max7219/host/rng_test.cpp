@@ -0,0 +1,436 @@
+/**
+Host-side quality check and throughput benchmark for the random number
+generators.
+
+First checks each generator against reference vectors: `Xoroshiro64` against
+a literal copy of Blackman and Vigna's reference ``next()``, its `jump()`
+against 2^32 steps of the reference, and every generator against outputs
+recorded from known seeds, so that any change to seeding or output is caught.
+
+Then runs each generator through three classic statistical tests, on a stream
+of bytes taken from ``next()``, low byte first:
+
+    Chi-square
+        Counts of each byte value, and of each pair of consecutive bytes,
+        against a uniform distribution.
+
+    Runs
+        The NIST SP 800-22 runs test: the number of unbroken runs of ones or
+        zeros in the bit stream, which also checks the balance of ones.
+
+    Birthday spacings
+        Marsaglia's test: 512 random 24-bit "birthdays" in a year of 2^24
+        days, sorted. The number of repeated spacings between them should be
+        Poisson distributed with mean 2. Short periods and lattice structure
+        show up here.
+
+Each test gives a p-value; below 0.001 is a failure. For the chi-square tests
+(and birthday spacings) so is above 0.999, a fit too good to be random. The
+frequency and runs p-values are already two-sided, so have no upper limit.
+Seeds are fixed, so results are repeatable.
+
+Finally reports throughput on the host. That says nothing about the cycles on
+the AVR (see ``../rng_benchmark.cpp``), but shows relative cost.
+
+Any class with ``result_type`` and ``next()`` can be qualified by adding a
+line to ``main()``. Generators of the 'good' quality must pass everything;
+the 'fast' ones are expected to fail some tests and are only reported.
+
+Usage::
+
+    ./rng_test [megabytes]      # Default 16MB of output per test
+
+Exits with status 1 on any required failure.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../prng.h"
+#include "../xoroshiro64.h"
+
+
+int failures = 0;
+size_t stream_bytes = size_t(16) << 20;
+
+const double p_low = 0.001;
+const double p_high = 0.999;
+
+
+/**
+Bytes from any generator's ``next()``, low byte first.
+*/
+template <typename Generator>
+class Bytes {
+    private:
+        using T = typename Generator::result_type;
+        Generator& rng;
+        T value = 0;
+        uint8_t left = 0;
+
+    public:
+        explicit Bytes(Generator& rng) : rng(rng) {}
+
+        uint8_t next() {
+            if ( left == 0 ) {
+                value = rng.next();
+                left = sizeof(T);
+            }
+            const uint8_t byte = value;
+            value = static_cast<T>(value >> 8);
+            --left;
+            return byte;
+        }
+};
+
+
+/**
+Regularised lower incomplete gamma function, P(a, x).
+
+Series for small x, continued fraction otherwise, after Numerical Recipes.
+*/
+double gamma_p(double a, double x) {
+    if ( x <= 0 ) {
+        return 0;
+    }
+    const double log_prefix = a * std::log(x) - x - std::lgamma(a);
+    if ( x < a + 1 ) {
+        double term = 1 / a;
+        double sum = term;
+        for (int n = 1; n < 10000; ++n) {
+            term *= x / (a + n);
+            sum += term;
+            if ( std::fabs(term) < std::fabs(sum) * 1e-15 ) {
+                break;
+            }
+        }
+        return sum * std::exp(log_prefix);
+    }
+    const double tiny = 1e-300;
+    double b = x + 1 - a;
+    double c = 1 / tiny;
+    double d = 1 / b;
+    double h = d;
+    for (int i = 1; i < 10000; ++i) {
+        const double an = -i * (i - a);
+        b += 2;
+        d = an * d + b;
+        d = ( std::fabs(d) < tiny ) ? tiny : d;
+        c = b + an / c;
+        c = ( std::fabs(c) < tiny ) ? tiny : c;
+        d = 1 / d;
+        const double delta = d * c;
+        h *= delta;
+        if ( std::fabs(delta - 1) < 1e-15 ) {
+            break;
+        }
+    }
+    return 1 - std::exp(log_prefix) * h;
+}
+
+
+/**
+Probability of a chi-square statistic at least this large.
+*/
+double chi_square_p(double statistic, unsigned dof) {
+    return 1 - gamma_p(dof / 2.0, statistic / 2.0);
+}
+
+
+double chi_square(const std::vector<uint64_t>& counts, const std::vector<double>& expected) {
+    double statistic = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        const double difference = counts[i] - expected[i];
+        statistic += difference * difference / expected[i];
+    }
+    return statistic;
+}
+
+
+/**
+Print a test result, and count it if it fails and is required.
+
+Args:
+    check_high: Also fail p above `p_high`, for a chi-square statistic.
+*/
+bool verdict(const char* test, double p, bool required, bool check_high) {
+    const bool pass = p >= p_low && (p <= p_high || !check_high);
+    printf("    %-22s p = %-10.6f %s\n", test, p,
+        pass ? "pass" : (required ? "FAIL" : "fail (expected)"));
+    if ( ! pass && required ) {
+        ++failures;
+    }
+    return pass;
+}
+
+
+template <typename Generator>
+void test_chi_square(bool required) {
+    Generator rng(0x1234);
+    Bytes<Generator> bytes(rng);
+    std::vector<uint64_t> singles(256);
+    std::vector<uint64_t> pairs(65536);
+    for (size_t i = 0; i < stream_bytes / 2; ++i) {
+        const uint8_t a = bytes.next();
+        const uint8_t b = bytes.next();
+        ++singles[a];
+        ++singles[b];
+        ++pairs[(a << 8) | b];
+    }
+    const std::vector<double> single_expected(256, double(stream_bytes) / 256);
+    const std::vector<double> pair_expected(65536, double(stream_bytes / 2) / 65536);
+    verdict("chi-square, bytes",
+        chi_square_p(chi_square(singles, single_expected), 255), required, true);
+    verdict("chi-square, pairs",
+        chi_square_p(chi_square(pairs, pair_expected), 65535), required, true);
+}
+
+
+template <typename Generator>
+void test_runs(bool required) {
+    Generator rng(0x5678);
+    Bytes<Generator> bytes(rng);
+    const double n = 8.0 * stream_bytes;
+    uint64_t ones = 0;
+    uint64_t runs = 1;
+    uint8_t previous = bytes.next();
+    ones += __builtin_popcount(previous);
+    uint8_t last_bit = previous & 0x01;
+    for (uint8_t bit = 1; bit < 8; ++bit) {
+        const uint8_t b = (previous >> bit) & 0x01;
+        runs += ( b != last_bit );
+        last_bit = b;
+    }
+    for (size_t i = 1; i < stream_bytes; ++i) {
+        const uint8_t byte = bytes.next();
+        ones += __builtin_popcount(byte);
+        for (uint8_t bit = 0; bit < 8; ++bit) {
+            const uint8_t b = (byte >> bit) & 0x01;
+            runs += ( b != last_bit );
+            last_bit = b;
+        }
+    }
+
+    // Frequency first: the runs test assumes the ones are balanced
+    const double pi = ones / n;
+    const double p_frequency = std::erfc(std::fabs(2 * (double)ones - n) / std::sqrt(2 * n));
+    verdict("frequency", p_frequency, required, false);
+    double p_runs = 0;
+    if ( std::fabs(pi - 0.5) < 2 / std::sqrt(n) ) {
+        p_runs = std::erfc(std::fabs(runs - 2 * n * pi * (1 - pi)) /
+            (2 * std::sqrt(2 * n) * pi * (1 - pi)));
+    }
+    verdict("runs", p_runs, required, false);
+}
+
+
+template <typename Generator>
+void test_birthday_spacings(bool required) {
+    const unsigned birthdays = 512;
+    const unsigned max_repeats = 6;     // Last bin is "six or more"
+    const double lambda = 2.0;
+    const unsigned samples = std::max<size_t>(stream_bytes / (3 * birthdays), 100);
+
+    Generator rng(0x9abc);
+    Bytes<Generator> bytes(rng);
+    std::vector<uint32_t> days(birthdays);
+    std::vector<uint32_t> spacings(birthdays);
+    std::vector<uint64_t> counts(max_repeats + 1);
+    for (unsigned sample = 0; sample < samples; ++sample) {
+        for (auto& day : days) {
+            day = bytes.next();
+            day |= bytes.next() << 8;
+            day |= bytes.next() << 16;
+        }
+        std::sort(days.begin(), days.end());
+        spacings[0] = days[0];
+        for (unsigned i = 1; i < birthdays; ++i) {
+            spacings[i] = days[i] - days[i - 1];
+        }
+        std::sort(spacings.begin(), spacings.end());
+        unsigned repeats = 0;
+        for (unsigned i = 1; i < birthdays; ++i) {
+            repeats += ( spacings[i] == spacings[i - 1] );
+        }
+        ++counts[std::min(repeats, max_repeats)];
+    }
+
+    std::vector<double> expected(max_repeats + 1);
+    double probability = std::exp(-lambda);
+    double remaining = 1;
+    for (unsigned k = 0; k < max_repeats; ++k) {
+        expected[k] = probability * samples;
+        remaining -= probability;
+        probability *= lambda / (k + 1);
+    }
+    expected[max_repeats] = remaining * samples;
+    verdict("birthday spacings",
+        chi_square_p(chi_square(counts, expected), max_repeats), required, true);
+}
+
+
+template <typename Generator>
+void test_throughput() {
+    Generator rng(0xdef0);
+    const size_t calls = stream_bytes;
+    typename Generator::result_type sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < calls; ++i) {
+        sink ^= rng.next();
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(stop - start).count();
+    const double per_second = calls / seconds;
+    volatile typename Generator::result_type keep = sink;   // Not optimised away
+    (void) keep;
+    printf("    %-22s %.0f M/s, %.0f MB/s\n", "throughput",
+        per_second / 1e6, per_second * sizeof(sink) / 1e6);
+}
+
+
+/**
+Run every statistical test, and time, one generator.
+
+Args:
+    name (const char*): For the report.
+    required (bool): Count failures towards the exit status.
+*/
+template <typename Generator>
+void qualify(const char* name, bool required) {
+    printf("%s (%d-bit output, %d-bit state)\n", name,
+        8 * (int)sizeof(typename Generator::result_type), Generator::state_bits);
+    test_chi_square<Generator>(required);
+    test_runs<Generator>(required);
+    test_birthday_spacings<Generator>(required);
+    test_throughput<Generator>();
+}
+
+
+/**
+Compare a generator's first outputs with recorded ones.
+*/
+template <typename Generator, size_t N>
+void check_vectors(const char* name, uint32_t seed, const uint32_t (&expected)[N]) {
+    Generator rng(seed);
+    for (size_t i = 0; i < N; ++i) {
+        const uint32_t found = rng.next();
+        if ( found != expected[i] ) {
+            printf("FAIL %s seed 0x%08x: output %zu is 0x%08x, expected 0x%08x\n",
+                name, seed, i, found, expected[i]);
+            ++failures;
+            return;
+        }
+    }
+    printf("%-26s reference vectors match\n", name);
+}
+
+
+/**
+Blackman and Vigna's reference xoroshiro64**, copied from their C source.
+*/
+static inline uint32_t reference_rotl(const uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+uint32_t reference_next(uint32_t s[2]) {
+    const uint32_t s0 = s[0];
+    uint32_t s1 = s[1];
+    const uint32_t result = reference_rotl(s0 * 0x9E3779BB, 5) * 5;
+
+    s1 ^= s0;
+    s[0] = reference_rotl(s0, 26) ^ s1 ^ (s1 << 9); // a, b
+    s[1] = reference_rotl(s1, 13); // c
+
+    return result;
+}
+
+
+void check_reference() {
+    // Reference implementation from a known state
+    static const uint32_t from_one_two[] = {0xe2ac153f, 0x30817eaa, 0x607a3436, 0xb030543b};
+    uint32_t state[2] = {1, 2};
+    for (size_t i = 0; i < 4; ++i) {
+        if ( reference_next(state) != from_one_two[i] ) {
+            printf("FAIL reference xoroshiro64** copy is wrong\n");
+            ++failures;
+            return;
+        }
+    }
+
+    // Xoroshiro64 against the reference, over a long stream
+    for (uint32_t seed : {0u, 1u, 0xdecafbadu}) {
+        uint32_t mix = seed;
+        uint32_t s[2];
+        s[0] = splitmix32(mix);
+        s[1] = splitmix32(mix);
+        Xoroshiro64 rng(seed);
+        for (uint32_t i = 0; i < 1000000; ++i) {
+            if ( rng.next() != reference_next(s) ) {
+                printf("FAIL Xoroshiro64 seed 0x%08x differs from reference at output %u\n",
+                    seed, i);
+                ++failures;
+                return;
+            }
+        }
+    }
+    printf("%-26s matches reference xoroshiro64**\n", "Xoroshiro64");
+}
+
+
+/**
+Compare `Xoroshiro64::jump()` with outputs recorded after stepping the
+reference 2^32 times from seed 1, which takes several seconds on the host.
+*/
+void check_jump() {
+    static const uint32_t after_jump[] = {0x1a3b394b, 0xd499b624, 0xc2c83ef5, 0xe6ede3f6};
+    Xoroshiro64 rng(1);
+    rng.jump();
+    for (size_t i = 0; i < 4; ++i) {
+        const uint32_t found = rng.next();
+        if ( found != after_jump[i] ) {
+            printf("FAIL Xoroshiro64::jump(): output %zu is 0x%08x, expected 0x%08x\n",
+                i, found, after_jump[i]);
+            ++failures;
+            return;
+        }
+    }
+    printf("%-26s jump() matches 2^32 steps\n", "Xoroshiro64");
+}
+
+
+int main(int argc, char** argv) {
+    if ( argc > 1 ) {
+        stream_bytes = size_t(std::max(1, atoi(argv[1]))) << 20;
+    }
+
+    check_reference();
+    check_jump();
+    static const uint32_t xoroshiro64[] = {0x6a3a9a13, 0xfe039245, 0x474500ea, 0xd4c43b15};
+    static const uint32_t xorshift8[] = {0x12, 0xe6, 0xd0, 0x72};
+    static const uint32_t xorshift16[] = {0x81cd, 0x197e, 0x8b2d, 0xbea3};
+    static const uint32_t xorshift32[] = {0xb836680d, 0xd3c9a056, 0x1fa16557, 0x52780692};
+    static const uint32_t xoroshiro32pp[] = {0x108b, 0x73b4, 0x1133, 0xee83};
+    check_vectors<Xoroshiro64>("Xoroshiro64", 1, xoroshiro64);
+    check_vectors<prng::Xorshift<uint8_t>>("Xorshift<uint8_t>", 1, xorshift8);
+    check_vectors<prng::Xorshift<uint16_t>>("Xorshift<uint16_t>", 1, xorshift16);
+    check_vectors<prng::Xorshift<uint32_t>>("Xorshift<uint32_t>", 1, xorshift32);
+    check_vectors<prng::Xoroshiro32pp>("Xoroshiro32pp", 1, xoroshiro32pp);
+
+    printf("\n%zuMB per test\n\n", stream_bytes >> 20);
+    qualify<Xoroshiro64>("Xoroshiro64", true);
+    qualify<prng::Xoroshiro32pp>("Xoroshiro32pp", true);
+    qualify<prng::Xorshift<uint32_t>>("Xorshift<uint32_t>", false);
+    qualify<prng::Xorshift<uint16_t>>("Xorshift<uint16_t>", false);
+    qualify<prng::Xorshift<uint8_t>>("Xorshift<uint8_t>", false);
+
+    if ( failures ) {
+        printf("\n%d FAILED\n", failures);
+        return 1;
+    }
+    printf("\nAll required tests passed.\n");
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <avr/io.h>
+
+#include "simulator.h"
+
+
+namespace host {
+
+
+/**
+Act on the word in the shift register, as on a rising edge of LOAD.
+*/
+void Chip::latch() {
+    const uint8_t address = (shift >> 8) & 0x0f;
+    const uint8_t data = shift & 0xff;
+    if ( address == 0x00 ) {
+        return;
+    }
+
+    ++commands;
+    if ( address <= 0x08 ) {
+        digits[address - 1] = data;
+        return;
+    }
+    switch ( address ) {
+        case 0x09:
+            decode_mode = data;
+            break;
+        case 0x0a:
+            intensity = data & 0x0f;
+            break;
+        case 0x0b:
+            scan_limit = data & 0x07;
+            break;
+        case 0x0c:
+            shutdown = data & 0x01;
+            break;
+        case 0x0f:
+            test = data & 0x01;
+            break;
+    }
+}
+
+
+/**
+Constructor.
+
+Attaches itself to PORTB and SPDR, replacing any previous chain.
+
+Args:
+    num_chips (uint8_t): Length of chain.
+    mosi, clock, chip_select (uint8_t): Pins on PORTB.
+*/
+VirtualChain::VirtualChain(
+        uint8_t num_chips, uint8_t mosi, uint8_t clock, uint8_t chip_select) :
+        chips(num_chips), mosi(mosi), clock(clock), chip_select(chip_select) {
+    PORTB.set_hook([this](uint8_t before, uint8_t after) { on_port(before, after); });
+    SPDR.set_hook([this](uint8_t before, uint8_t after) { on_spi(before, after); });
+}
+
+
+VirtualChain::~VirtualChain() {
+    PORTB.set_hook(nullptr);
+    SPDR.set_hook(nullptr);
+}
+
+
+void VirtualChain::reset_counts() {
+    clock_edges = 0;
+    latches = 0;
+    for (auto& chip : chips) {
+        chip.commands = 0;
+    }
+}
+
+
+/**
+Shift one bit into the first chip, rippling through the chain.
+
+The MAX7219 shifts on every clock edge, whatever the state of LOAD.
+*/
+void VirtualChain::shift_in(bool bit) {
+    ++clock_edges;
+    for (auto& chip : chips) {
+        const bool out = chip.shift & 0x8000;
+        chip.shift = (chip.shift << 1) | bit;
+        bit = out;
+    }
+}
+
+
+void VirtualChain::on_port(uint8_t before, uint8_t after) {
+    const uint8_t rising = ~before & after;
+    if ( rising & (1 << clock) ) {
+        shift_in(after & (1 << mosi));
+    }
+    if ( rising & (1 << chip_select) ) {
+        ++latches;
+        for (auto& chip : chips) {
+            chip.latch();
+        }
+    }
+}
+
+
+/**
+A write to SPDR sends a whole byte, and sets SPIF.
+*/
+void VirtualChain::on_spi(uint8_t, uint8_t after) {
+    for (uint8_t mask = 0x80; mask; mask >>= 1) {
+        shift_in(after & mask);
+    }
+    SPSR.poke(SPSR.peek() | (1 << SPIF));
+}
+
+
+} // namespace host
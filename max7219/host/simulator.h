@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "registers.h"
+
+
+namespace host {
+
+
+/**
+One virtual MAX7219: a 16-bit shift register and the chip's registers.
+*/
+struct Chip {
+    uint16_t shift = 0;
+    uint8_t digits[8] = {};
+    uint8_t decode_mode = 0;
+    uint8_t intensity = 0;
+    uint8_t scan_limit = 0;
+    uint8_t shutdown = 0;       // Zero is shut down, as at power-up
+    uint8_t test = 0;
+    uint32_t commands = 0;      // Latched words, not counting no-ops
+
+    void latch();
+};
+
+
+/**
+A daisy-chain of virtual MAX7219 chips, decoding the signals written to a port.
+
+Watches writes to the port register: every rising edge on the clock pin shifts
+the data pin into the first chip, whose top bit overflows into the next chip,
+and so on. A rising edge on chip select latches every chip's shift register
+into the register it addresses, exactly as the real chips do.
+
+Alternatively, watch the SPI data register, where every write shifts in a
+whole byte, MSB first.
+
+Chip zero is the one nearest the MCU.
+*/
+class VirtualChain {
+    private:
+        std::vector<Chip> chips;
+        uint8_t mosi;
+        uint8_t clock;
+        uint8_t chip_select;
+
+        void shift_in(bool bit);
+        void on_port(uint8_t before, uint8_t after);
+        void on_spi(uint8_t before, uint8_t after);
+
+    public:
+        uint32_t clock_edges = 0;
+        uint32_t latches = 0;
+
+        VirtualChain(uint8_t num_chips, uint8_t mosi, uint8_t clock, uint8_t chip_select);
+        ~VirtualChain();
+        Chip& chip(uint8_t index) { return chips.at(index); }
+        uint8_t size() const { return chips.size(); }
+        void reset_counts();
+};
+
+
+} // namespace host
@@ -0,0 +1,9 @@
+#pragma once
+
+
+/**
+Host stand-in for avr-libc's <util/atomic.h>. Runs the block once.
+*/
+#define ATOMIC_RESTORESTATE     0
+#define ATOMIC_FORCEON          0
+#define ATOMIC_BLOCK(type)      for (bool _done = false; ! _done; _done = true)
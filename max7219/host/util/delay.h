@@ -0,0 +1,8 @@
+#pragma once
+
+
+/**
+Host stand-in for avr-libc's <util/delay.h>. Time is free.
+*/
+inline void _delay_ms(double) {}
+inline void _delay_us(double) {}
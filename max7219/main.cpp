@@ -1,26 +1,29 @@
 
-#include <stdlib.h>
 #include <util/delay.h>
 
-#include "max7219.h"
+#include "cascade.h"
+#include "framebuffer.h"
+#include "xoroshiro64.h"
 
 
-auto display = max7219::MAX7219(PB2, PB3, PB4);
+auto display = max7219::fixed::Cascade<1, max7219::PortB, PB2, PB3, PB4>();
+auto buffer = max7219::fixed::Framebuffer<decltype(display)>();
+Xoroshiro64 rng(0xdecafbad);
 
 
 void random_digit() {
-    uint16_t rand = random();
+    uint16_t rand = rng.next();
     uint8_t digit = (rand & 0x00FF) >> 5;   // Top three bits of LSB
-    uint8_t value = rand % 10;
-    display.set_digit(digit, value);
+    uint8_t value = rng.uniform(10);
+    buffer.set_digit(0, digit, value);
 }
 
 
 void random_pattern() {
-    uint16_t rand = random();
+    uint16_t rand = rng.next();
     uint8_t digit = (rand & 0x00FF) >> 5;   // Top three bits of LSB
     uint8_t value = (rand >> 10);
-    display.set_digit(digit, value);
+    buffer.set_digit(0, digit, value);
 }
 
 
@@ -32,6 +35,7 @@ void main() {
     uint16_t count = 0;
     while (true) {
         random_pattern();
+        buffer.flush();
         _delay_ms(100);
 
         ++count;
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+#include "framebuffer.h"
+
+
+namespace max7219 {
+
+
+namespace fixed {
+
+
+/**
+Pixel canvas spanning a chain of 8x8 LED matrix modules.
+
+The modules are laid out left to right, with chip zero (nearest the MCU) on the
+left. Within a module each digit register is a row, digit zero at the top,
+and bit 7 is the left-most column. Modules wired the other way round can be
+used by reversing the order of the glyphs. The canvas is ``8 * size`` pixels wide
+and 8 high::
+
+    auto chain = max7219::fixed::Cascade<4, max7219::PortB, PB2, PB3, PB4>();
+    auto canvas = max7219::fixed::Matrix<decltype(chain)>();
+    chain.init();
+    chain.use_decode_mode(false);
+    canvas.blit(glyph_A, 5, 0);
+    canvas.flush();
+
+Everything is drawn into a `Framebuffer`, so only rows that actually change
+are sent by `flush()`.
+
+Scrolling moves bytes within the framebuffer rather than redrawing: shifting
+the whole canvas one column is a single shift-with-carry across each row, about
+10 cycles per module per row. Scrolling text is just a loop feeding in the
+glyph's columns one at a time from the right::
+
+    for (uint8_t i = 0; i < 5; ++i) {
+        canvas.scroll_left(pgm_read_byte(&glyph_A[i]));
+        canvas.flush();
+        _delay_ms(30);
+    }
+
+Glyphs are stored in flash, column by column, one byte per column with bit
+zero at the top. This is the layout of most classic 5x7 LCD fonts.
+
+Args:
+    Chain: Type of the `Cascade` driving the modules.
+*/
+template <typename Chain>
+class Matrix {
+    public:
+        static constexpr uint8_t size = Chain::size;
+        static constexpr uint16_t width = 8 * static_cast<uint16_t>(size);
+        static constexpr uint8_t height = 8;
+
+    private:
+        Framebuffer<Chain> buffer;
+
+    public:
+        /**
+        Direct access to the framebuffer.
+        */
+        Framebuffer<Chain>& framebuffer() {
+            return buffer;
+        }
+
+        /**
+        Send changed rows to the modules, see `Framebuffer::flush()`.
+        */
+        uint8_t flush() {
+            return buffer.flush();
+        }
+
+        /**
+        Turn off all pixels.
+        */
+        void clear() {
+            buffer.clear();
+        }
+
+        /**
+        True if pixel is on. Pixels off the canvas are off.
+        */
+        bool get_pixel(uint16_t x, uint8_t y) const {
+            if ( x >= width || y >= height ) {
+                return false;
+            }
+            return buffer.get_digit(x >> 3, y) & (0x80 >> (x & 0x07));
+        }
+
+        /**
+        Turn pixel on. Pixels off the canvas are ignored.
+        */
+        void set_pixel(uint16_t x, uint8_t y) {
+            if ( x >= width || y >= height ) {
+                return;
+            }
+            const uint8_t chip = x >> 3;
+            buffer.set_digit(chip, y, buffer.get_digit(chip, y) | (0x80 >> (x & 0x07)));
+        }
+
+        /**
+        Turn pixel off. Pixels off the canvas are ignored.
+        */
+        void clear_pixel(uint16_t x, uint8_t y) {
+            if ( x >= width || y >= height ) {
+                return;
+            }
+            const uint8_t chip = x >> 3;
+            buffer.set_digit(chip, y, buffer.get_digit(chip, y) & ~(0x80 >> (x & 0x07)));
+        }
+
+        /**
+        Turn pixel on or off.
+        */
+        void write_pixel(uint16_t x, uint8_t y, bool on) {
+            if ( on ) {
+                set_pixel(x, y);
+            } else {
+                clear_pixel(x, y);
+            }
+        }
+
+        /**
+        Overwrite a single column, bit zero at the top.
+        */
+        void set_column(uint16_t x, uint8_t column) {
+            if ( x >= width ) {
+                return;
+            }
+            const uint8_t chip = x >> 3;
+            const uint8_t mask = (0x80 >> (x & 0x07));
+            for (uint8_t y = 0; y < height; ++y) {
+                uint8_t row = buffer.get_digit(chip, y);
+                row = (column & 0x01) ? (row | mask) : (row & ~mask);
+                buffer.set_digit(chip, y, row);
+                column >>= 1;
+            }
+        }
+
+        /**
+        Copy glyph from flash onto canvas.
+
+        The glyph's columns replace those of the canvas, clipped at the edges.
+
+        Args:
+            glyph (const uint8_t*): Glyph in PROGMEM, one byte per column.
+            columns (uint8_t): Width of glyph.
+            x (int16_t): Canvas column for left edge of glyph. May be negative.
+        */
+        void blit(const uint8_t* glyph, uint8_t columns, int16_t x) {
+            for (uint8_t i = 0; i < columns; ++i, ++x) {
+                if ( x >= 0 ) {
+                    set_column(x, pgm_read_byte(&glyph[i]));
+                }
+            }
+        }
+
+        /**
+        Move everything one column to the left.
+
+        Args:
+            column (uint8_t): New right-most column, bit zero at the top.
+        */
+        void scroll_left(uint8_t column=0x00) {
+            for (uint8_t y = 0; y < height; ++y) {
+                uint8_t carry = (column >> y) & 0x01;
+                for (uint8_t chip = size; chip-- > 0; ) {
+                    const uint8_t row = buffer.get_digit(chip, y);
+                    buffer.set_digit(chip, y, (row << 1) | carry);
+                    carry = row >> 7;
+                }
+            }
+        }
+
+        /**
+        Move everything one column to the right.
+
+        Args:
+            column (uint8_t): New left-most column, bit zero at the top.
+        */
+        void scroll_right(uint8_t column=0x00) {
+            for (uint8_t y = 0; y < height; ++y) {
+                uint8_t carry = ((column >> y) & 0x01) << 7;
+                for (uint8_t chip = 0; chip < size; ++chip) {
+                    const uint8_t row = buffer.get_digit(chip, y);
+                    buffer.set_digit(chip, y, (row >> 1) | carry);
+                    carry = row << 7;
+                }
+            }
+        }
+
+        /**
+        Move everything one row up, blanking the bottom row.
+        */
+        void scroll_up() {
+            for (uint8_t chip = 0; chip < size; ++chip) {
+                for (uint8_t y = 0; y < height - 1; ++y) {
+                    buffer.set_digit(chip, y, buffer.get_digit(chip, y + 1));
+                }
+                buffer.set_digit(chip, height - 1, 0x00);
+            }
+        }
+
+        /**
+        Move everything one row down, blanking the top row.
+        */
+        void scroll_down() {
+            for (uint8_t chip = 0; chip < size; ++chip) {
+                for (uint8_t y = height - 1; y > 0; --y) {
+                    buffer.set_digit(chip, y, buffer.get_digit(chip, y - 1));
+                }
+                buffer.set_digit(chip, 0, 0x00);
+            }
+        }
+};
+
+
+} // namespace fixed
+
+
+} // namespace max7219
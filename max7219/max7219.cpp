@@ -173,6 +173,89 @@ void MAX7219::set_test_mode(bool do_led_test) {
 }
 
 
+/**
+Show an unsigned decimal number, 0 to 99,999,999.
+
+Turns decode mode on, and sets all eight digits. Digit zero is taken to be the
+right-most, least-significant digit. The conversion is done without division,
+see `format::decimal()`, so it is fast enough for rapidly changing counters.
+
+Args:
+    value (uint32_t): Number to show. Hyphens are shown if it doesn't fit.
+    leading_blank (bool): Blank leading zeros using Code B's blank, 0x0F.
+
+Returns:
+    bool: False on overflow.
+*/
+bool MAX7219::display_uint32(uint32_t value, bool leading_blank) {
+    uint8_t digits[format::num_digits];
+    bool fits = format::decimal(value, digits, leading_blank);
+    show(digits, true);
+    return fits;
+}
+
+
+/**
+Show a signed decimal number, -9,999,999 to 99,999,999.
+
+Args:
+    value (int32_t): Number to show. Hyphens are shown if it doesn't fit.
+    leading_blank (bool): Blank leading zeros. The minus sign moves with them.
+*/
+bool MAX7219::display_int(int32_t value, bool leading_blank) {
+    uint8_t digits[format::num_digits];
+    bool fits = format::signed_decimal(value, digits, leading_blank);
+    show(digits, true);
+    return fits;
+}
+
+
+/**
+Show a fixed-point number, using a decimal point.
+
+For example, ``display_fixed(-1234, 2)`` shows "-12.34".
+
+Args:
+    value (int32_t): Number to show, multiplied by 10 to the power of decimals.
+    decimals (uint8_t): Number of digits after the decimal point.
+    leading_blank (bool): Blank leading zeros, but never the units digit.
+*/
+bool MAX7219::display_fixed(int32_t value, uint8_t decimals, bool leading_blank) {
+    uint8_t digits[format::num_digits];
+    bool fits = format::fixed_point(value, decimals, digits, leading_blank);
+    show(digits, true);
+    return fits;
+}
+
+
+/**
+Show a 32-bit number in hexadecimal.
+
+Code B has no letters past 'E', so decode mode is turned off and raw
+segment patterns are sent instead, from a table in flash.
+
+Args:
+    value (uint32_t): Number to show.
+    leading_blank (bool): Turn off all segments of leading zeros.
+*/
+void MAX7219::display_hex(uint32_t value, bool leading_blank) {
+    uint8_t segments[format::num_digits];
+    format::hexadecimal(value, segments, leading_blank);
+    show(segments, false);
+}
+
+
+/**
+Send all eight digits, setting decode mode to suit them first.
+*/
+void MAX7219::show(const uint8_t* digits, bool decoded) {
+    use_decode_mode(decoded);
+    for (uint8_t digit = 0; digit < format::num_digits; ++digit) {
+        transmit(digit + 1, digits[digit]);
+    }
+}
+
+
 /**
 Send low-level command to chip.
 
@@ -4,6 +4,7 @@
 #include <avr/io.h>
 
 #include "../common.h"
+#include "format.h"
 
 
 #define DDR     DDRB
@@ -34,6 +35,7 @@ muliplexing with a frequency greater than 500Hz.
 
 Were you to chain 16 chips together and run an animation at 60Hz the clock would need to
 run at an average of 500kHz. You may want to switch to hardware SPI in this case...
+See `fixed::MAX7219` and the `HardwareSPI` transport.
 
 Provides a fairly direct interface to the chips functionality. Abstractions
 are left for higher levels of code.
@@ -43,6 +45,7 @@ class MAX7219 {
         const uint8_t mosi;
         const uint8_t clock;
         const uint8_t chip_select;
+        void show(const uint8_t* digits, bool decoded);
 
     public:
         MAX7219(uint8_t data, uint8_t clock, uint8_t chip_select);
@@ -53,6 +56,10 @@ class MAX7219 {
         void set_scan_limit(uint8_t digits);
         void set_shutdown(bool);
         void set_test_mode(bool);
+        bool display_uint32(uint32_t value, bool leading_blank=true);
+        bool display_int(int32_t value, bool leading_blank=true);
+        bool display_fixed(int32_t value, uint8_t decimals, bool leading_blank=true);
+        void display_hex(uint32_t value, bool leading_blank=true);
         void transmit(const uint8_t& address, const uint8_t& body);
 };
 
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "xoroshiro64.h"
+
+
+/**
+A family of pseudo-random number generators sized for an 8-bit CPU.
+
+`Xoroshiro64` is good, but its 32-bit multiply and rotates are expensive on
+the AVR. These generators keep their state in 8, 16, or 32 bits, and use only
+shifts, rotates, xors, and (for one) a 16-bit add.
+
+All share the interface of `Xoroshiro64`:
+
+``result_type``
+    Unsigned type returned by ``next()``.
+
+``state_bits``
+    Size of state. Every generator here has period ``2^state_bits - 1``,
+    checked by brute force on the host for all but `Xoroshiro64`.
+
+``Generator(uint32_t seed)``, ``seed(uint32_t)``
+    Seed from a 32-bit number, via `splitmix32()`. State is never zero.
+
+``next()``, ``fill(buffer, length)``
+    One output, or fill a byte buffer using every bit of every output.
+
+Choose one at compile time by output width and quality::
+
+    prng::Random<16, prng::Quality::fast> rng(seed);
+    uint16_t value = rng.next();
+
+    ======  =======  ====================  ========  ==========
+    Bits    Quality  Generator             Period    Cycles [1]
+    ======  =======  ====================  ========  ==========
+    8       fast     `Xorshift<uint8_t>`   2^8 - 1   ~20
+    16      fast     `Xorshift<uint16_t>`  2^16 - 1  ~35
+    32      fast     `Xorshift<uint32_t>`  2^32 - 1  ~85
+    8, 16   good     `Xoroshiro32pp`       2^32 - 1  ~80
+    32      good     `Xoroshiro64`         2^64 - 1  ~320
+    ======  =======  ====================  ========  ==========
+
+[1] Per call to ``next()``, hand-estimated for -Os. Measure them on the chip
+    using ``rng_benchmark.cpp``.
+
+``host/rng_test.cpp`` checks them all against reference vectors and a few
+statistical tests; run it before trusting a new generator.
+
+The 'fast' tier are Marsaglia's xorshift generators. Fine for flickering LEDs,
+but every output bit is a linear function of the state, and the short periods
+of the small ones will show: an 8-bit xorshift repeats every 255 calls, and
+never returns zero. The 'good' tier add a non-linear scrambler to a xoroshiro
+generator, and pass far more statistical tests.
+*/
+namespace prng {
+
+
+enum class Quality : uint8_t {
+    fast,
+    good,
+};
+
+
+/**
+Shared implementation of `fill()`, using every byte of every output.
+*/
+template <typename Derived, typename T>
+class Generator {
+    public:
+        using result_type = T;
+        static constexpr uint8_t state_bits = 8 * sizeof(T);
+
+        void fill(uint8_t* buffer, size_t length) {
+            Derived& self = *static_cast<Derived*>(this);
+            while ( length ) {
+                T value = self.next();
+                for (uint8_t i = 0; i < sizeof(T) && length; ++i, --length) {
+                    *buffer++ = value;
+                    value >>= 8;
+                }
+            }
+        }
+};
+
+
+/**
+Shift triples for `Xorshift`, each checked to give a full period.
+*/
+template <typename T> struct XorshiftShifts;
+
+template <> struct XorshiftShifts<uint8_t> {
+    static constexpr uint8_t a = 3, b = 5, c = 4;
+};
+
+template <> struct XorshiftShifts<uint16_t> {
+    static constexpr uint8_t a = 7, b = 9, c = 8;
+};
+
+template <> struct XorshiftShifts<uint32_t> {
+    static constexpr uint8_t a = 13, b = 17, c = 5;
+};
+
+
+/**
+Marsaglia's xorshift generator, on a single 8, 16, or 32-bit word.
+
+Period 2^8 - 1, 2^16 - 1, or 2^32 - 1: every value but zero, once each.
+
+Args:
+    T: ``uint8_t``, ``uint16_t``, or ``uint32_t``.
+*/
+template <typename T>
+class Xorshift : public Generator<Xorshift<T>, T> {
+    private:
+        using Shifts = XorshiftShifts<T>;
+        T state;
+
+    public:
+        explicit Xorshift(uint32_t seed=0) {
+            this->seed(seed);
+        }
+
+        void seed(uint32_t seed) {
+            state = splitmix32(seed);
+            if ( state == 0 ) {
+                state = 1;
+            }
+        }
+
+        T next() {
+            T x = state;
+            x ^= x << Shifts::a;
+            x ^= x >> Shifts::b;
+            x ^= x << Shifts::c;
+            state = x;
+            return x;
+        }
+};
+
+
+/**
+The xoroshiro32++ generator: two 16-bit words of state, 16-bit output.
+
+Parameters [a, b, c, d] = [13, 5, 10, 9], after the xoroshiro32 search
+published by the Parallax Propeller 2 community. Period 2^32 - 1.
+
+Unlike the xorshift generators, the '++' scrambler (a rotate and two 16-bit
+adds) makes every output bit non-linear in the state, and each 16-bit output
+value appears (almost) equally often over the period.
+*/
+class Xoroshiro32pp : public Generator<Xoroshiro32pp, uint16_t> {
+    private:
+        uint16_t state[2];
+
+        static inline uint16_t rotl(const uint16_t x, uint8_t k) {
+            return (x << k) | (x >> (16 - k));
+        }
+
+    public:
+        static constexpr uint8_t state_bits = 32;
+
+        explicit Xoroshiro32pp(uint32_t seed=0) {
+            this->seed(seed);
+        }
+
+        void seed(uint32_t seed) {
+            const uint32_t mixed = splitmix32(seed);
+            state[0] = mixed;
+            state[1] = mixed >> 16;
+            if ( state[0] == 0 && state[1] == 0 ) {
+                state[0] = 1;
+            }
+        }
+
+        uint16_t next() {
+            const uint16_t s0 = state[0];
+            uint16_t s1 = state[1];
+            const uint16_t result = rotl(s0 + s1, 9) + s0;
+
+            s1 ^= s0;
+            state[0] = rotl(s0, 13) ^ s1 ^ (s1 << 5);
+            state[1] = rotl(s1, 10);
+            return result;
+        }
+};
+
+
+/**
+Pick a generator at compile time, see `Random`.
+*/
+template <uint8_t bits, Quality quality> struct Select;
+
+template <> struct Select<8, Quality::fast> { using type = Xorshift<uint8_t>; };
+template <> struct Select<16, Quality::fast> { using type = Xorshift<uint16_t>; };
+template <> struct Select<32, Quality::fast> { using type = Xorshift<uint32_t>; };
+template <> struct Select<8, Quality::good> { using type = Xoroshiro32pp; };
+template <> struct Select<16, Quality::good> { using type = Xoroshiro32pp; };
+template <> struct Select<32, Quality::good> { using type = Xoroshiro64; };
+
+
+/**
+The cheapest generator of at least the given output width and quality.
+
+Args:
+    bits: Output width: 8, 16, or 32.
+    quality: `Quality::fast` or `Quality::good`.
+*/
+template <uint8_t bits, Quality quality = Quality::good>
+using Random = typename Select<bits, quality>::type;
+
+
+} // namespace prng
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "framebuffer.h"
+
+
+namespace max7219 {
+
+
+namespace fixed {
+
+
+/**
+Keep re-sending every register, slowly, to recover from corruption.
+
+Electrical noise can flip bits in the chips' registers. A corrupted scan-limit,
+decode-mode, or shutdown register will garble the display until it is written
+again, and ordinarily nothing ever writes it again.
+
+This class keeps a shadow of the configuration registers, to go with the digits
+in a `Framebuffer`, and re-sends one register at a time, round-robin, to every
+chip in the chain. Configuration first, then the eight digits: thirteen frames
+for a full pass. Recovery never costs more than a single frame at a time.
+
+The work is split in two, so that the main loop and an ISR never fight over
+the bus. A timer ISR calls `tick()`, which only counts. The main loop calls
+`service()`, which sends a frame if one is due::
+
+    auto chain = max7219::fixed::Cascade<4, max7219::PortB, PB2, PB3, PB4>();
+    auto buffer = max7219::fixed::Framebuffer<decltype(chain)>();
+    auto refresher = max7219::fixed::Refresher<decltype(chain)>(chain, buffer, 10);
+
+    ISR(TIMER2_COMPA_vect) {
+        refresher.tick();               // 1kHz
+    }
+
+    refresher.init();
+    while (true) {
+        draw_things(buffer);
+        buffer.flush();
+        refresher.service();
+    }
+
+Bandwidth is capped by the `period`: at most one frame per `period` ticks. With
+a 1kHz tick and a period of 10 that's 100 frames a second, a full pass every
+130ms, and (bit-banging four chips) under 1% of an 8MHz CPU.
+
+The refresher stands aside while there are foreground updates waiting to be
+flushed, so it never delays them.
+
+Configuration must be changed through this class, rather than the `Cascade`,
+to keep the shadow up-to-date.
+
+Args:
+    Chain: Type of the `Cascade` driving the chips.
+*/
+template <typename Chain>
+class Refresher {
+    public:
+        static constexpr uint8_t size = Chain::size;
+
+    private:
+        // Shadowed configuration registers, in the order they are refreshed
+        static constexpr uint8_t num_settings = 5;
+        static constexpr uint8_t addresses[num_settings] = {0x0c, 0x0b, 0x09, 0x0a, 0x0f};
+        static constexpr uint8_t shutdown = 0;
+        static constexpr uint8_t scan_limit = 1;
+        static constexpr uint8_t decode_mode = 2;
+        static constexpr uint8_t intensity = 3;
+        static constexpr uint8_t test = 4;
+        static constexpr uint8_t num_registers = num_settings + 8;
+
+        Chain& chain;
+        Framebuffer<Chain>& buffer;
+        uint8_t settings[num_settings];
+        uint8_t next = 0;
+        const uint8_t period;
+        volatile uint8_t countdown;
+        volatile bool due = false;
+
+        void write_setting(uint8_t index, uint8_t value) {
+            settings[index] = value;
+            chain.transmit_all(addresses[index], value);
+        }
+
+    public:
+        /**
+        Constructor.
+
+        Args:
+            chain (Chain&): Chips to refresh.
+            buffer (Framebuffer&): Shadow of digits.
+            period (uint8_t): Ticks between refresh frames, at least one.
+        */
+        Refresher(Chain& chain, Framebuffer<Chain>& buffer, uint8_t period) :
+                chain(chain), buffer(buffer), period(period ? period : 1) {
+            countdown = this->period;
+            settings[shutdown] = 0x01;
+            settings[scan_limit] = 0x07;
+            settings[decode_mode] = 0x00;
+            settings[intensity] = 0x08;
+            settings[test] = 0x00;
+        }
+
+        /**
+        Send every setting and digit, as `Cascade::init()`.
+
+        Decode mode starts off, as most chained displays are LED matrices.
+        This is the only full burst; after it only single frames are sent.
+        */
+        void init(uint8_t brightness=8) {
+            write_setting(test, 0x00);
+            set_scan_limit(8);
+            use_decode_mode(false);
+            set_brightness(brightness);
+            set_shutdown(false);
+            buffer.invalidate();
+            buffer.flush();
+        }
+
+        void set_brightness(uint8_t brightness) {
+            brightness = ( brightness > 15) ? 15 : brightness;
+            write_setting(intensity, brightness);
+        }
+
+        void use_decode_mode(bool do_decoding) {
+            write_setting(decode_mode, do_decoding ? 0xff : 0x00);
+        }
+
+        void set_scan_limit(uint8_t limit) {
+            limit = ( limit < 1 ) ? 1 : limit;
+            limit = ( limit > 8 ) ? 8 : limit;
+            write_setting(scan_limit, limit - 1);
+        }
+
+        void set_shutdown(bool do_shutdown) {
+            write_setting(shutdown, do_shutdown ? 0x00 : 0x01);
+        }
+
+        void set_test_mode(bool do_led_test) {
+            write_setting(test, do_led_test ? 0x01 : 0x00);
+        }
+
+        /**
+        Count down to the next refresh frame. Call from timer ISR.
+        */
+        void tick() {
+            if ( --countdown == 0 ) {
+                countdown = period;
+                due = true;
+            }
+        }
+
+        /**
+        Send the next register in the round-robin, if one is due.
+
+        Call from the main loop. Does nothing while the framebuffer has changes
+        waiting to be flushed.
+
+        Returns:
+            bool: True if a frame was sent.
+        */
+        bool service() {
+            if ( ! due || buffer.is_dirty() ) {
+                return false;
+            }
+            due = false;
+
+            if ( next < num_settings ) {
+                chain.transmit_all(addresses[next], settings[next]);
+            } else {
+                const uint8_t digit = next - num_settings;
+                uint8_t row[size];
+                for (uint8_t chip = 0; chip < size; ++chip) {
+                    row[chip] = buffer.get_digit(chip, digit);
+                }
+                chain.transmit_row(digit + 1, row);
+            }
+            next = ( next + 1 == num_registers ) ? 0 : next + 1;
+            return true;
+        }
+};
+
+
+template <typename Chain>
+constexpr uint8_t Refresher<Chain>::addresses[];
+
+
+} // namespace fixed
+
+
+} // namespace max7219
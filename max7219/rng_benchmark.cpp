@@ -0,0 +1,130 @@
+/**
+Measure random number generators on the chip, in CPU cycles.
+
+Timer1 counts CPU cycles directly. Each generator is called repeatedly, then
+fills a buffer, and the counts are shown on the display: generator number in
+the left-most digit, then four digits of cycles per call to ``next()``, then
+three of cycles per byte from ``fill()``. Each is shown for two seconds, in
+turn:
+
+    ==  =========================
+    1   avr-libc `random()`
+    2   `Xoroshiro64`
+    3   `prng::Xorshift<uint8_t>`
+    4   `prng::Xorshift<uint16_t>`
+    5   `prng::Xorshift<uint32_t>`
+    6   `prng::Xoroshiro32pp`
+    7   `Xoroshiro64::uniform()` and `fill_uniform()`, digits 0 to 9
+    ==  =========================
+
+Both counts include loop overhead of a few cycles.
+*/
+
+#include <avr/io.h>
+#include <stdlib.h>
+#include <util/delay.h>
+
+#include "fixed.h"
+#include "prng.h"
+#include "xoroshiro64.h"
+
+
+auto display = max7219::fixed::MAX7219<max7219::PortB, PB2, PB3, PB4>();
+const uint8_t buffer_size = 48;
+const uint8_t calls = 32;
+volatile uint8_t buffer[buffer_size];
+
+
+void start_counter() {
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);           // No prescaler, counts CPU cycles
+    TCNT1 = 0;
+}
+
+
+/**
+avr-libc's `random()`, keeping two bytes of its 31 bits, as the demo did.
+*/
+uint32_t measure_random() {
+    volatile uint32_t sink;
+    start_counter();
+    for (uint8_t i = 0; i < calls; ++i) {
+        sink = random();
+    }
+    const uint16_t per_call = TCNT1 / calls;
+
+    start_counter();
+    for (uint8_t i = 0; i < buffer_size; i += 2) {
+        uint16_t value = random();
+        buffer[i] = value;
+        buffer[i+1] = value >> 8;
+    }
+    const uint16_t per_byte = TCNT1 / buffer_size;
+    (void) sink;
+    return per_call * 1000UL + per_byte;
+}
+
+
+/**
+Any generator with ``next()`` and ``fill()``.
+*/
+template <typename Generator>
+uint32_t measure() {
+    Generator rng(12345);
+    volatile typename Generator::result_type sink;
+    start_counter();
+    for (uint8_t i = 0; i < calls; ++i) {
+        sink = rng.next();
+    }
+    const uint16_t per_call = TCNT1 / calls;
+
+    uint8_t local[buffer_size];
+    start_counter();
+    rng.fill(local, buffer_size);
+    const uint16_t per_byte = TCNT1 / buffer_size;
+    buffer[0] = local[0];
+    (void) sink;
+    return per_call * 1000UL + per_byte;
+}
+
+
+/**
+Random digits: ``uniform(10)`` per call, ``fill_uniform(..., 10)`` per byte.
+*/
+uint32_t measure_uniform() {
+    Xoroshiro64 rng(12345);
+    volatile uint16_t sink;
+    start_counter();
+    for (uint8_t i = 0; i < calls; ++i) {
+        sink = rng.uniform(10);
+    }
+    const uint16_t per_call = TCNT1 / calls;
+
+    uint8_t local[buffer_size];
+    start_counter();
+    rng.fill_uniform(local, buffer_size, 10);
+    const uint16_t per_byte = TCNT1 / buffer_size;
+    buffer[0] = local[0];
+    (void) sink;
+    return per_call * 1000UL + per_byte;
+}
+
+
+void show(uint8_t generator, uint32_t cycles) {
+    display.display_uint32(generator * 10000000UL + cycles);
+    _delay_ms(2000);
+}
+
+
+void main() {
+    display.init();
+    while (true) {
+        show(1, measure_random());
+        show(2, measure<Xoroshiro64>());
+        show(3, measure<prng::Xorshift<uint8_t>>());
+        show(4, measure<prng::Xorshift<uint16_t>>());
+        show(5, measure<prng::Xorshift<uint32_t>>());
+        show(6, measure<prng::Xoroshiro32pp>());
+        show(7, measure_uniform());
+    }
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <stdint.h>
+#include <avr/io.h>
+
+
+namespace max7219 {
+
+
+/**
+Compile-time handles to the I/O ports.
+
+Used as template arguments so that the register addresses are known to the
+compiler, letting it emit single-cycle ``sbi`` and ``cbi`` instructions instead of
+a read-modify-write of the whole port.
+
+The return types follow the register macros, so that the host build in
+``host/`` can substitute registers that watch what is written to them.
+*/
+struct PortB {
+    static constexpr char name = 'B';
+    static auto port() -> decltype((PORTB)) { return PORTB; }
+    static auto ddr() -> decltype((DDRB)) { return DDRB; }
+};
+
+
+struct PortC {
+    static constexpr char name = 'C';
+    static auto port() -> decltype((PORTC)) { return PORTC; }
+    static auto ddr() -> decltype((DDRC)) { return DDRC; }
+};
+
+
+struct PortD {
+    static constexpr char name = 'D';
+    static auto port() -> decltype((PORTD)) { return PORTD; }
+    static auto ddr() -> decltype((DDRD)) { return DDRD; }
+};
+
+
+/**
+Transport policies.
+
+How the bits actually get to the chip. Each transport is a class template over
+the same four parameters, providing the same four static functions:
+
+``init()``
+    Configure pins (and peripheral, if any), and leave chip select high.
+
+``select()``
+    Drop chip select ('Load') low, to start a frame.
+
+``send(byte)``
+    Shift out one byte, most-significant bit first.
+
+``deselect()``
+    Raise chip select. The chip latches the last 16 bits it received on this
+    rising edge.
+
+``cycles_per_word``
+    Rough cost of sending one 16-bit word, in CPU cycles, for use in planning
+    bandwidth budgets.
+
+Pick one with the last template argument of `fixed::MAX7219`.
+*/
+
+
+/**
+Bit-bang the protocol on any three pins of one port.
+
+The fallback, and the default. Leaves the SPI peripheral free for another device.
+About 8 cycles per bit, see `fixed::MAX7219`.
+*/
+template <typename Port, uint8_t mosi, uint8_t clock, uint8_t chip_select>
+struct BitBang {
+    static_assert(mosi < 8 && clock < 8 && chip_select < 8, "Pin numbers are 0 to 7");
+    static_assert(mosi != clock && mosi != chip_select && clock != chip_select,
+        "Pins must be distinct");
+
+    static constexpr uint16_t cycles_per_word = 135;
+
+    static inline void init() {
+        Port::ddr() |= (1 << mosi) | (1 << clock) | (1 << chip_select);
+        Port::port() |= (1 << chip_select);
+    }
+
+    static inline void select() {
+        Port::port() &= ~(1 << chip_select);
+    }
+
+    static inline void deselect() {
+        Port::port() |= (1 << chip_select);
+    }
+
+    static inline void send_bit(bool high) {
+        Port::port() &= ~(1 << clock);
+        if ( high ) {
+            Port::port() |= (1 << mosi);
+        } else {
+            Port::port() &= ~(1 << mosi);
+        }
+        Port::port() |= (1 << clock);
+    }
+
+    static inline void send(uint8_t byte) {
+        send_bit(byte & 0x80);
+        send_bit(byte & 0x40);
+        send_bit(byte & 0x20);
+        send_bit(byte & 0x10);
+        send_bit(byte & 0x08);
+        send_bit(byte & 0x04);
+        send_bit(byte & 0x02);
+        send_bit(byte & 0x01);
+    }
+};
+
+
+/**
+Use the SPI peripheral, clocked at F_CPU/2.
+
+The data and clock pins are fixed in hardware, MOSI on PB3 (Arduino pin 11)
+and SCK on PB5 (pin 13). Chip select may be any other spare pin. The SS pin,
+PB2, is the natural choice: it has to be an output anyway, lest the peripheral
+drop out of master mode whenever it is pulled low::
+
+    max7219::fixed::MAX7219<max7219::PortB, PB3, PB5, PB2, max7219::HardwareSPI>
+
+The port argument gives the port of the chip select pin only.
+
+SPI mode 0, MSB first. A byte takes 16 CPU cycles on the wire, plus a few to
+poll ``SPIF``: about 40 cycles for a whole 16-bit transmit, against about 135
+for `BitBang`. The MAX7219 is good for 10MHz, so even a 16MHz part is inside
+the spec at F_CPU/2.
+
+Roughly a 3x higher frame rate than bit-banging, or about 30x the original
+runtime `MAX7219` class.
+*/
+template <typename Port, uint8_t mosi, uint8_t clock, uint8_t chip_select>
+struct HardwareSPI {
+    static_assert(mosi == PB3 && clock == PB5, "SPI uses MOSI=PB3 and SCK=PB5");
+    static_assert(chip_select < 8, "Pin numbers are 0 to 7");
+    static_assert(Port::name != 'B' || (chip_select != PB3 && chip_select != PB4
+        && chip_select != PB5), "MOSI, MISO, and SCK cannot be used as chip select");
+
+    static constexpr uint16_t cycles_per_word = 40;
+
+    static inline void init() {
+        // SS must be an output to stay in master mode
+        DDRB |= (1 << PB3) | (1 << PB5) | (1 << PB2);
+        Port::ddr() |= (1 << chip_select);
+        Port::port() |= (1 << chip_select);
+        SPCR = (1 << SPE) | (1 << MSTR);
+        SPSR = (1 << SPI2X);
+    }
+
+    static inline void select() {
+        Port::port() &= ~(1 << chip_select);
+    }
+
+    static inline void deselect() {
+        Port::port() |= (1 << chip_select);
+    }
+
+    static inline void send(uint8_t byte) {
+        SPDR = byte;
+        while ( ! (SPSR & (1 << SPIF)) ) {
+        }
+    }
+};
+
+
+} // namespace max7219
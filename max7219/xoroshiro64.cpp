@@ -1,9 +1,31 @@
-
 #include <stdint.h>
 
 #include "xoroshiro64.h"
 
 
+/**
+Constructor, see `seed()`.
+*/
+Xoroshiro64::Xoroshiro64(uint32_t seed) {
+  this->seed(seed);
+}
+
+
+/**
+Initialise state from a single 32-bit seed.
+
+Uses `splitmix32()`, so every seed, even zero, gives a well-mixed, non-zero
+state.
+*/
+void Xoroshiro64::seed(uint32_t seed) {
+  state[0] = splitmix32(seed);
+  state[1] = splitmix32(seed);
+  if ( state[0] == 0 && state[1] == 0 ) {
+    state[0] = 1;
+  }
+}
+
+
 uint32_t Xoroshiro64::next() {
   const uint32_t s0 = state[0];
   uint32_t s1 = state[1];
@@ -15,3 +37,128 @@ uint32_t Xoroshiro64::next() {
 
   return result_starstar;
 }
+
+
+/**
+Advance the state by 2^32 steps, as if `next()` had been called 2^32 times.
+
+Gives up to 2^32 non-overlapping streams from one seed, for independent
+uses of the generator. Seed once, then copy and jump::
+
+    Xoroshiro64 a(seed);
+    Xoroshiro64 b = a;
+    b.jump();
+
+The polynomial is x^(2^32) modulo the characteristic polynomial of the
+generator's linear transformation. Costs 64 calls to `next()`.
+*/
+void Xoroshiro64::jump() {
+  static const uint32_t JUMP[] = { 0x77fcd1a0, 0x4cbf99bd };
+
+  uint32_t s0 = 0;
+  uint32_t s1 = 0;
+  for (uint8_t i = 0; i < 2; ++i) {
+    for (uint8_t b = 0; b < 32; ++b) {
+      if ( JUMP[i] & (UINT32_C(1) << b) ) {
+        s0 ^= state[0];
+        s1 ^= state[1];
+      }
+      next();
+    }
+  }
+  state[0] = s0;
+  state[1] = s1;
+}
+
+
+/**
+Fill buffer with random bytes, using all 32 bits of every output.
+
+Args:
+    buffer (uint8_t*): Destination.
+    length (size_t): Number of bytes to fill.
+*/
+void Xoroshiro64::fill(uint8_t* buffer, size_t length) {
+  while ( length >= 4 ) {
+    uint32_t value = next();
+    buffer[0] = value;
+    buffer[1] = value >> 8;
+    buffer[2] = value >> 16;
+    buffer[3] = value >> 24;
+    buffer += 4;
+    length -= 4;
+  }
+  if ( length ) {
+    uint32_t value = next();
+    while ( length-- ) {
+      *buffer++ = value;
+      value >>= 8;
+    }
+  }
+}
+
+
+/**
+Uniform random number in ``[0, n)``, without bias and without a division.
+
+Lemire's multiply-shift method: a 16-bit random number times ``n`` is a 32-bit
+product whose top half is the result. The few products whose bottom half falls
+under ``2^16 mod n`` would make some results more likely than others, so are
+rejected and redrawn. That threshold needs a division, but it is only worked
+out when the bottom half is under ``n``, which is rare for small ``n``.
+
+About 60 cycles more than `next()`, hand-estimated: the 16x16 multiply is a
+handful of ``mul`` instructions, where ``next() % n`` calls a 32-bit division
+of 500 cycles or more, and favours the low results.
+
+Args:
+    n (uint16_t): Number of possible results. Zero always gives zero.
+
+Returns:
+    uint16_t: Between zero and ``n - 1``.
+*/
+uint16_t Xoroshiro64::uniform(uint16_t n) {
+  uint32_t product = static_cast<uint32_t>(static_cast<uint16_t>(next() >> 16)) * n;
+  uint16_t low = product;
+  if ( low < n ) {
+    const uint16_t threshold = static_cast<uint16_t>(0 - n) % n;
+    while ( low < threshold ) {
+      product = static_cast<uint32_t>(static_cast<uint16_t>(next() >> 16)) * n;
+      low = product;
+    }
+  }
+  return product >> 16;
+}
+
+
+/**
+Fill array with uniform random numbers in ``[0, n)``, as `uniform()`.
+
+Works in 8 bits, so each output of `next()` gives four values, and each
+multiply is a single ``mul`` instruction. Around 35 cycles per value for
+``n = 10``, hand-estimated.
+
+Args:
+    values (uint8_t*): Destination.
+    length (size_t): Number of values to generate.
+    n (uint8_t): Number of possible results. Zero always gives zero.
+*/
+void Xoroshiro64::fill_uniform(uint8_t* values, size_t length, uint8_t n) {
+  const uint8_t threshold = n ? static_cast<uint8_t>(0 - n) % n : 0;
+  uint32_t bits = 0;
+  uint8_t available = 0;
+  while ( length ) {
+    if ( available == 0 ) {
+      bits = next();
+      available = 4;
+    }
+    const uint16_t product = static_cast<uint8_t>(bits) * n;
+    bits >>= 8;
+    --available;
+    if ( static_cast<uint8_t>(product) < threshold ) {
+      continue;
+    }
+    *values++ = product >> 8;
+    --length;
+  }
+}
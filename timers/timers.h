@@ -1,13 +1,16 @@
 #pragma once
 
 #include <avr/io.h>
+#include <util/atomic.h>
 
 
 /**
 A tiny AVR timer library, just to cover common-use cases.
 
 It's structured as stand-alone functions, to allow for minimal code size, and to mix well
-with manual overriding of the many various buttons and knobs available.  This
+with manual overriding of the many various buttons and knobs available. The functions
+in `timer0`, `timer1`, and `timer2` are thin wrappers around `Timer`, which gives all
+three timers the same API, and can set everything with a single write per register.  This
 documentation is arguably the most important part - I find the register names difficult
 to differentiate, so it's nice to have them spelled out. Even if I'm the one doing the
 spelling.
@@ -29,6 +32,11 @@ Speaking of confusingly named registers, here's a brief overview:
     Lots and lots of possible combinations... Confusingly, most of the bits *inside*
     these registers also have their own names. eg. ``COMnA``, ``WGMnn``, ``CSnn``.
 
+``ICR1``
+    Input Capture Register. Only on the 16-bit ``timer1``. Latches ``TCNT1`` when
+    the ICP1 pin changes, but far more often used as a 16-bit TOP for the PWM
+    modes, leaving both ``OCR1A`` and ``OCR1B`` free for duty-cycles.
+
 */
 namespace timers {
 
@@ -45,6 +53,684 @@ enum class Clock : byte {
 };
 
 
+namespace timer0 {
+    /**
+    Prescaler values for timer0, and timer1.
+
+    Not the same as `timers::Clock`, which is for timer2 only: there is no
+    32 or 128, but the timer can be clocked from pin T0 (PD4) instead.
+    */
+    enum class Clock : byte {
+        Stopped         = 0x00,
+        Divide_by_1     = (1 << CS00),
+        Divide_by_8     = (1 << CS01),
+        Divide_by_64    = ((1 << CS00) | (1 << CS01)),
+        Divide_by_256   = (1 << CS02),
+        Divide_by_1024  = ((1 << CS00) | (1 << CS02)),
+        External_falling = ((1 << CS01) | (1 << CS02)),
+        External_rising = ((1 << CS00) | (1 << CS01) | (1 << CS02)),
+    };
+} // namespace timer0
+
+
+/**
+Waveform modes, for working out frequencies with `Frequency` and `Period`.
+
+Each has its own relation between frequency, prescaler ``N``, and TOP:
+
+`ctc`
+    Compare match interupts in CTC mode, ``F_CPU / N * (1 + TOP)``.
+
+`ctc_toggle`
+    Square wave from an output toggled in CTC mode, ``F_CPU / 2 * N * (1 + TOP)``.
+
+`pwm_fast`
+    Fast PWM with adjustable TOP, ``F_CPU / N * (1 + TOP)``. `set_mode_pwm_faster()`
+    on timer0 and timer2, `timer1::set_mode_pwm_fast_icr()` on timer1.
+
+`pwm_phase_correct`
+    Phase correct PWM with adjustable TOP, ``F_CPU / 2 * N * TOP``. On timer1 only,
+    as `timer1::set_mode_pwm_phase_correct_icr()`.
+*/
+enum class Mode : byte {
+    ctc,
+    ctc_toggle,
+    pwm_fast,
+    pwm_phase_correct,
+};
+
+
+namespace solver {
+    /**
+    What the solver needs to know about each timer.
+    */
+    template <uint8_t timer> struct Traits;
+
+    template <> struct Traits<2> {
+        using Clock = timers::Clock;
+        static constexpr uint16_t max_top = 255;
+
+        static constexpr uint16_t divisor(uint8_t index) {
+            return (index == 0) ? 1 : (index == 1) ? 8 : (index == 2) ? 32 :
+                (index == 3) ? 64 : (index == 4) ? 128 : (index == 5) ? 256 :
+                (index == 6) ? 1024 : 0;
+        }
+
+        static constexpr Clock clock(uint16_t divisor) {
+            return (divisor == 1) ? Clock::Divide_by_1 :
+                (divisor == 8) ? Clock::Divide_by_8 :
+                (divisor == 32) ? Clock::Divide_by_32 :
+                (divisor == 64) ? Clock::Divide_by_64 :
+                (divisor == 128) ? Clock::Divide_by_128 :
+                (divisor == 256) ? Clock::Divide_by_256 :
+                (divisor == 1024) ? Clock::Divide_by_1024 : Clock::Stopped;
+        }
+    };
+
+    template <> struct Traits<0> {
+        using Clock = timer0::Clock;
+        static constexpr uint16_t max_top = 255;
+
+        static constexpr uint16_t divisor(uint8_t index) {
+            return (index == 0) ? 1 : (index == 1) ? 8 : (index == 2) ? 64 :
+                (index == 3) ? 256 : (index == 4) ? 1024 : 0;
+        }
+
+        static constexpr Clock clock(uint16_t divisor) {
+            return (divisor == 1) ? Clock::Divide_by_1 :
+                (divisor == 8) ? Clock::Divide_by_8 :
+                (divisor == 64) ? Clock::Divide_by_64 :
+                (divisor == 256) ? Clock::Divide_by_256 :
+                (divisor == 1024) ? Clock::Divide_by_1024 : Clock::Stopped;
+        }
+    };
+
+    template <> struct Traits<1> : Traits<0> {
+        static constexpr uint16_t max_top = 65535;
+    };
+
+    struct Solution {
+        uint16_t divisor;       // Zero if there is no solution
+        uint16_t top;
+        uint32_t cycles;        // CPU cycles per period achieved
+    };
+
+    /**
+    Best prescaler and TOP for a period of ``num / den`` CPU cycles.
+
+    Tries every prescaler, rounding TOP to nearest, and keeps the smallest
+    error. The PWM modes need a TOP of at least 3, for two bits of resolution.
+    Ties go to the smaller prescaler, for the larger TOP and so the finer PWM
+    resolution.
+    */
+    template <uint8_t timer>
+    constexpr Solution solve(Mode mode, uint64_t num, uint64_t den) {
+        const bool doubled = (mode == Mode::ctc_toggle || mode == Mode::pwm_phase_correct);
+        const uint8_t offset = (mode == Mode::pwm_phase_correct) ? 0 : 1;
+        const uint8_t min_top = (mode == Mode::ctc || mode == Mode::ctc_toggle) ? 0 : 3;
+        Solution best = {0, 0, 0};
+        uint64_t best_error = 0;
+        for (uint8_t i = 0; Traits<timer>::divisor(i); ++i) {
+            const uint64_t unit = uint64_t(Traits<timer>::divisor(i)) * (doubled ? 2 : 1);
+            const uint64_t count = (num + unit * den / 2) / (unit * den);
+            if ( count < offset + min_top || count - offset > Traits<timer>::max_top ) {
+                continue;
+            }
+            const uint64_t achieved = count * unit * den;
+            const uint64_t error = (achieved > num) ? achieved - num : num - achieved;
+            if ( best.divisor == 0 || error < best_error ) {
+                best = {Traits<timer>::divisor(i), uint16_t(count - offset), uint32_t(count * unit)};
+                best_error = error;
+            }
+        }
+        return best;
+    }
+
+    /**
+    Common to `Frequency` and `Period`: a target of ``num / den`` CPU cycles.
+    */
+    template <uint8_t timer, Mode mode, uint64_t num, uint64_t den, uint32_t f_cpu>
+    struct Solved {
+        static_assert(timer <= 2, "Only timer0, timer1, and timer2");
+        static_assert(mode != Mode::pwm_phase_correct || timer == 1,
+            "Phase correct PWM only has an adjustable TOP on timer1");
+        static_assert(num > 0 && den > 0, "Target must be greater than zero");
+        static_assert(solve<timer>(mode, num, den).divisor != 0,
+            "Target out of range for this timer and mode");
+
+        using Clock = typename Traits<timer>::Clock;
+
+        /// Prescaler divisor, eg. 64
+        static constexpr uint16_t prescaler = solve<timer>(mode, num, den).divisor;
+
+        /// Prescaler, for `use_prescaler()`
+        static constexpr Clock clock = Traits<timer>::clock(prescaler);
+
+        /// Value for ``OCRnA`` or ``ICR1``
+        static constexpr uint16_t top = solve<timer>(mode, num, den).top;
+
+        /// CPU cycles per period, as achieved
+        static constexpr uint32_t cycles = solve<timer>(mode, num, den).cycles;
+
+        /// Frequency achieved, in Hz
+        static constexpr double frequency = cycles ? double(f_cpu) / cycles : 0;
+
+        /// Error of achieved period, in parts per million. Positive is too slow.
+        static constexpr int32_t error_ppm = cycles ?
+            (int64_t(uint64_t(cycles) * den) - int64_t(num)) * 1000000 / int64_t(num) : 0;
+    };
+} // namespace solver
+
+
+/**
+Work out prescaler and TOP for a target frequency, at compile time.
+
+No more hand-computed constants, and no more comments that have drifted from
+the code. Nothing is left for run-time but the constants::
+
+    using Tick = timers::Frequency<2, timers::Mode::ctc, 1000>;
+
+    timer2::set_mode_ctc();
+    OCR2A = Tick::top;
+    timer2::use_prescaler(Tick::clock);
+    timer2::use_interupts(timer2::interupts::match_OCR2A);
+
+If the target can't be reached at all the build fails. If it can only be
+approached, `error_ppm` says how closely, and can be checked too::
+
+    static_assert(Tick::error_ppm == 0, "Tick must be exactly 1ms");
+
+For the 1kHz tick above:
+
+    =======  =========  ===  =====
+    F_CPU    Prescaler  TOP  Error
+    =======  =========  ===  =====
+    1MHz     8          124  0
+    8MHz     32         249  0
+    16MHz    64         249  0
+    =======  =========  ===  =====
+
+Members:
+
+``prescaler``, ``clock``
+    Prescaler, as a number and as the timer's `Clock` for `use_prescaler()`.
+
+``top``
+    For ``OCRnA``, or ``ICR1`` in the timer1 ICR modes.
+
+``cycles``, ``frequency``, ``error_ppm``
+    CPU cycles per period, frequency in Hz, and error, all as achieved.
+
+Args:
+    timer: 0, 1, or 2.
+    mode: See `Mode`.
+    hz: Target frequency, in Hz.
+    f_cpu: CPU clock, defaults to ``F_CPU``.
+*/
+template <uint8_t timer, Mode mode, uint32_t hz, uint32_t f_cpu = F_CPU>
+struct Frequency : solver::Solved<timer, mode, f_cpu, hz, f_cpu> {};
+
+
+/**
+As `Frequency`, but for a target period in microseconds::
+
+    using Blink = timers::Period<1, timers::Mode::ctc, 500000>;
+*/
+template <uint8_t timer, Mode mode, uint32_t microseconds, uint32_t f_cpu = F_CPU>
+struct Period : solver::Solved<timer, mode, uint64_t(f_cpu) * microseconds, 1000000, f_cpu> {};
+
+
+/**
+Waveform generation modes, shared by every `Timer`.
+
+The same modes have different ``WGMn`` numbers on the 8 and 16-bit timers;
+`Timer` translates. The ``_icr`` modes, and ``ICR1``, only exist on timer1.
+See the functions in `timer0`, `timer1`, and `timer2` for the details of each.
+*/
+enum class Waveform : byte {
+    normal,
+    ctc,                                // OCRnA as TOP
+    pwm_fast,                           // 8-bit
+    pwm_phase_correct,                  // 8-bit
+    pwm_faster,                         // Fast PWM, OCRnA as TOP
+    pwm_phase_correct_ocra,             // Phase correct PWM, OCRnA as TOP
+    ctc_icr,
+    pwm_fast_icr,
+    pwm_phase_correct_icr,
+    pwm_phase_frequency_correct_icr,
+};
+
+
+/**
+Output compare modes, for either output of any `Timer`.
+
+See `timer2::output_a` for what they do in each mode.
+*/
+enum class Output : byte {
+    disconnected    = 0x00,
+    toggle          = 0x01,
+    non_inverting   = 0x02,
+    inverting       = 0x03,
+};
+
+
+/**
+Interupt enable bits, the same for every `Timer`.
+*/
+namespace interupts {
+    constexpr byte overflow         = (1 << TOIE0);
+    constexpr byte match_A          = (1 << OCIE0A);
+    constexpr byte match_B          = (1 << OCIE0B);
+    constexpr byte input_capture    = (1 << ICIE1);     // timer1 only
+}
+
+
+/**
+The registers of each timer, resolved at compile time.
+*/
+template <uint8_t n> struct Registers;
+
+template <> struct Registers<0> {
+    static auto control_a() -> decltype((TCCR0A)) { return TCCR0A; }
+    static auto control_b() -> decltype((TCCR0B)) { return TCCR0B; }
+    static auto interupt_mask() -> decltype((TIMSK0)) { return TIMSK0; }
+    static auto interupt_flags() -> decltype((TIFR0)) { return TIFR0; }
+    static auto counter() -> decltype((TCNT0)) { return TCNT0; }
+    static auto compare_a() -> decltype((OCR0A)) { return OCR0A; }
+    static auto compare_b() -> decltype((OCR0B)) { return OCR0B; }
+};
+
+template <> struct Registers<1> {
+    static auto control_a() -> decltype((TCCR1A)) { return TCCR1A; }
+    static auto control_b() -> decltype((TCCR1B)) { return TCCR1B; }
+    static auto interupt_mask() -> decltype((TIMSK1)) { return TIMSK1; }
+    static auto interupt_flags() -> decltype((TIFR1)) { return TIFR1; }
+    static auto counter() -> decltype((TCNT1)) { return TCNT1; }
+    static auto compare_a() -> decltype((OCR1A)) { return OCR1A; }
+    static auto compare_b() -> decltype((OCR1B)) { return OCR1B; }
+    static auto input_capture() -> decltype((ICR1)) { return ICR1; }
+};
+
+template <> struct Registers<2> {
+    static auto control_a() -> decltype((TCCR2A)) { return TCCR2A; }
+    static auto control_b() -> decltype((TCCR2B)) { return TCCR2B; }
+    static auto interupt_mask() -> decltype((TIMSK2)) { return TIMSK2; }
+    static auto interupt_flags() -> decltype((TIFR2)) { return TIFR2; }
+    static auto counter() -> decltype((TCNT2)) { return TCNT2; }
+    static auto compare_a() -> decltype((OCR2A)) { return OCR2A; }
+    static auto compare_b() -> decltype((OCR2B)) { return OCR2B; }
+};
+
+
+/**
+One API for all three timers, with no run-time cost.
+
+The three timers lay out their control registers identically: output modes in
+the top nibble of ``TCCRnA``, ``WGMn`` bits at the bottom of ``TCCRnA`` and
+bits 3 and 4 of ``TCCRnB``, and the clock in the bottom three bits of
+``TCCRnB``. Only the register addresses, the prescalers, and the mode numbers
+differ, and those are all worked out at compile time. Every function inlines
+to a few ``lds``/``sts`` instructions on fixed addresses.
+
+Each setter changes its bits with a single read-modify-write per register.
+`configure()` goes further: it sets everything at once, so each register is
+simply written, without being read at all::
+
+    using Tick = timers::Frequency<2, timers::Mode::ctc, 1000>;
+    using Timer2 = timers::Timer<2>;
+
+    Timer2::compare_a() = Tick::top;
+    Timer2::configure<timers::Waveform::ctc>(
+        timers::Output::disconnected, timers::Output::disconnected,
+        Tick::clock, timers::interupts::match_A);
+
+That's three ``sts`` instructions, where setting mode, outputs, prescaler, and
+interupts separately is seven read-modify-write sequences. Modes a timer does
+not have fail to compile.
+
+Args:
+    n: Timer number, 0, 1, or 2.
+*/
+template <uint8_t n>
+class Timer {
+    static_assert(n <= 2, "Only timer0, timer1, and timer2");
+
+    private:
+        using R = Registers<n>;
+
+        static constexpr byte outputs_mask = 0xf0;
+        static constexpr byte wgm_a_mask = 0x03;
+        static constexpr byte wgm_b_mask = 0x18;
+        static constexpr byte clock_mask = 0x07;
+        static constexpr byte interupts_mask = (n == 1) ? 0x27 : 0x07;
+        static constexpr byte unsupported = 0xff;
+
+        /**
+        The ``WGMn`` number of a mode on this timer.
+        */
+        static constexpr byte wgm(Waveform mode) {
+            if ( n == 1 ) {
+                switch ( mode ) {
+                    case Waveform::normal:                          return 0;
+                    case Waveform::ctc:                             return 4;
+                    case Waveform::pwm_fast:                        return 5;
+                    case Waveform::pwm_phase_correct:               return 1;
+                    case Waveform::pwm_faster:                      return 15;
+                    case Waveform::pwm_phase_correct_ocra:          return 11;
+                    case Waveform::ctc_icr:                         return 12;
+                    case Waveform::pwm_fast_icr:                    return 14;
+                    case Waveform::pwm_phase_correct_icr:           return 10;
+                    case Waveform::pwm_phase_frequency_correct_icr: return 8;
+                }
+                return unsupported;
+            }
+            switch ( mode ) {
+                case Waveform::normal:                  return 0;
+                case Waveform::ctc:                     return 2;
+                case Waveform::pwm_fast:                return 3;
+                case Waveform::pwm_phase_correct:       return 1;
+                case Waveform::pwm_faster:              return 7;
+                case Waveform::pwm_phase_correct_ocra:  return 5;
+                default:                                return unsupported;
+            }
+        }
+
+        static constexpr byte wgm_a(byte wgm) {
+            return wgm & wgm_a_mask;
+        }
+
+        static constexpr byte wgm_b(byte wgm) {
+            return (wgm << 1) & wgm_b_mask;
+        }
+
+        static constexpr byte outputs(Output a, Output b) {
+            return (static_cast<byte>(a) << 6) | (static_cast<byte>(b) << 4);
+        }
+
+    public:
+        using Clock = typename solver::Traits<n>::Clock;
+        static constexpr uint16_t max_top = solver::Traits<n>::max_top;
+
+        static auto counter() -> decltype(R::counter()) { return R::counter(); }
+        static auto compare_a() -> decltype(R::compare_a()) { return R::compare_a(); }
+        static auto compare_b() -> decltype(R::compare_b()) { return R::compare_b(); }
+
+        /**
+        ``ICR1``, timer1 only.
+        */
+        static auto input_capture() -> decltype((ICR1)) {
+            static_assert(n == 1, "Only timer1 has an input capture register");
+            return Registers<1>::input_capture();
+        }
+
+        /**
+        Set waveform generation mode, leaving outputs and clock alone.
+        */
+        template <Waveform mode>
+        static void set_mode() {
+            static_assert(wgm(mode) != unsupported, "Mode not available on this timer");
+            set_wgm(wgm(mode));
+        }
+
+        /**
+        Set waveform generation mode by ``WGMn`` number, from the datasheet.
+        */
+        static void set_wgm(byte wgm) {
+            R::control_a() = (R::control_a() & ~wgm_a_mask) | wgm_a(wgm);
+            R::control_b() = (R::control_b() & ~wgm_b_mask) | wgm_b(wgm);
+        }
+
+        static void use_outputs(Output a, Output b=Output::disconnected) {
+            R::control_a() = (R::control_a() & ~outputs_mask) | outputs(a, b);
+        }
+
+        /**
+        Enable (or disable) interupt handlers, see `timers::interupts`.
+        */
+        static void use_interupts(byte value) {
+            R::interupt_mask() = (R::interupt_mask() & ~interupts_mask) | value;
+        }
+
+        /**
+        Start the clock and set its prescaler.
+        */
+        static void use_prescaler(Clock prescaler) {
+            R::control_b() = (R::control_b() & ~clock_mask) | static_cast<byte>(prescaler);
+        }
+
+        /**
+        Set mode, outputs, prescaler, and interupts in one go.
+
+        Overwrites all of ``TIMSKn``, ``TCCRnA``, and ``TCCRnB``, in that
+        order, so the clock only starts once everything else is ready. Input
+        capture settings and force-output-compare bits are cleared.
+        */
+        template <Waveform mode>
+        static void configure(Output a, Output b, Clock prescaler, byte interupts=0) {
+            static_assert(wgm(mode) != unsupported, "Mode not available on this timer");
+            R::interupt_mask() = interupts;
+            R::control_a() = outputs(a, b) | wgm_a(wgm(mode));
+            R::control_b() = wgm_b(wgm(mode)) | static_cast<byte>(prescaler);
+        }
+
+        /**
+        Stop the clock, leaving everything else alone.
+        */
+        static void stop() {
+            use_prescaler(Clock::Stopped);
+        }
+};
+
+
+/**
+Microsecond and millisecond timestamps, from a free-running timer.
+
+The timer counts in normal mode, and its overflow ISR extends the count in
+software: one 32-bit add, plus keeping a running total of milliseconds. Reads
+are atomic, and safe against an overflow that has happened but not yet been
+handled. Call `overflow()` from the timer's overflow ISR::
+
+    timers::Timestamps<1> clock;
+
+    ISR(TIMER1_OVF_vect) {
+        clock.overflow();
+    }
+
+    clock.start();
+    sei();
+    uint32_t start = clock.micros();
+    do_something();
+    uint32_t elapsed = clock.micros() - start;
+
+`micros()` wraps after 71 minutes, and `millis()` after 49 days. Subtract, as
+above, and wrapping does no harm.
+
+The prescaler is chosen to suit the timer. timer1 runs as fast as it can
+while still counting whole microseconds (or halves, at 16MHz). The 8-bit
+timers run just slow enough to overflow no more than once a millisecond, as
+Arduino does with timer0.
+
+    =====  =====  =========  ==========  ===========  ========
+    Timer  F_CPU  Prescaler  Resolution  ISRs/second  CPU load
+    =====  =====  =========  ==========  ===========  ========
+    1      1MHz   1          1us         15           0.1%
+    1      8MHz   8          1us         15           0.01%
+    1      16MHz  8          0.5us       31           0.01%
+    0      1MHz   8          8us         488          3.4%
+    0, 2   8MHz   64, 32     8us, 4us    488, 977     0.4-0.9%
+    0, 2   16MHz  64         4us         977          0.4%
+    =====  =====  =========  ==========  ===========  ========
+
+Costs, hand-counted from the instruction timings:
+
+`overflow()` ISR
+    About 70 cycles, including entry and exit.
+
+`ticks()`, `micros()`
+    About 40 and 50 cycles.
+
+`millis()`
+    About 60 cycles, plus 6 for every millisecond since the last overflow: at
+    most 3 more on an 8-bit timer, but up to 67 more on timer1.
+
+Use timer1 for precise timing. On an Arduino, leave timer0 alone.
+
+Args:
+    n: Timer to use: 0, 1, or 2. Takes the whole timer.
+    f_cpu: CPU clock, a whole number of MHz. Defaults to ``F_CPU``.
+*/
+template <uint8_t n, uint32_t f_cpu = F_CPU>
+class Timestamps {
+    private:
+        using Traits = solver::Traits<n>;
+        using R = Registers<n>;
+
+        static constexpr uint16_t mhz = f_cpu / 1000000;
+        static_assert(mhz > 0 && f_cpu % 1000000 == 0, "CPU clock must be a whole number of MHz");
+
+        /**
+        Largest prescaler up to `mhz` for timer1; for the 8-bit timers the
+        smallest that takes at least a millisecond to overflow.
+        */
+        static constexpr uint16_t choose_prescaler() {
+            uint16_t chosen = 1;
+            for (uint8_t i = 0; Traits::divisor(i); ++i) {
+                const uint16_t divisor = Traits::divisor(i);
+                if ( n == 1 ) {
+                    if ( divisor <= mhz ) {
+                        chosen = divisor;
+                    }
+                } else {
+                    chosen = divisor;
+                    if ( 256UL * divisor / mhz >= 1000 ) {
+                        break;
+                    }
+                }
+            }
+            return chosen;
+        }
+
+    public:
+        static constexpr uint16_t prescaler = choose_prescaler();
+        static constexpr uint32_t ticks_per_overflow = uint32_t(Traits::max_top) + 1;
+        static constexpr uint16_t us_per_tick = (prescaler >= mhz) ? prescaler / mhz : 0;
+        static constexpr uint16_t ticks_per_us = (prescaler < mhz) ? mhz / prescaler : 0;
+        static constexpr uint32_t us_per_overflow = ticks_per_overflow * prescaler / mhz;
+
+        static_assert((prescaler >= mhz) ? (prescaler % mhz == 0) : (mhz % prescaler == 0),
+            "Timer ticks must be a whole number of microseconds, or the reverse");
+
+    private:
+        static constexpr uint16_t ms_per_overflow = us_per_overflow / 1000;
+        static constexpr uint16_t us_remainder = us_per_overflow % 1000;
+
+        volatile uint32_t overflows = 0;
+        volatile uint32_t ms = 0;
+        volatile uint16_t us = 0;           // Microseconds past `ms`, under 1000
+
+        static uint32_t to_us(uint16_t ticks) {
+            return us_per_tick ? uint32_t(ticks) * us_per_tick : ticks / (ticks_per_us ? ticks_per_us : 1);
+        }
+
+        /**
+        Overflow flag is set, but the ISR has not yet run: interupts are off.
+
+        Reads the counter again if so, as it may have been read just before
+        wrapping round.
+        */
+        static bool pending(uint16_t& ticks) {
+            if ( R::interupt_flags() & (1 << TOV0) ) {
+                ticks = R::counter();
+                return true;
+            }
+            return false;
+        }
+
+    public:
+        /**
+        Start the timer, in normal mode with the overflow interupt enabled.
+
+        Interupts must also be enabled, with ``sei()``.
+        */
+        void start() {
+            R::counter() = 0;
+            R::interupt_flags() = (1 << TOV0);      // Cleared by writing one
+            Timer<n>::template configure<Waveform::normal>(
+                Output::disconnected, Output::disconnected,
+                Traits::clock(prescaler), interupts::overflow);
+        }
+
+        /**
+        Count an overflow. Call from the timer's overflow ISR only.
+        */
+        void overflow() {
+            overflows = overflows + 1;
+            uint16_t remainder = us + us_remainder;
+            uint32_t whole = ms + ms_per_overflow;
+            if ( remainder >= 1000 ) {
+                remainder -= 1000;
+                ++whole;
+            }
+            us = remainder;
+            ms = whole;
+        }
+
+        /**
+        Raw count of timer ticks, see `us_per_tick` and `ticks_per_us`.
+
+        The cheapest timestamp. Wraps at 2^32 ticks.
+        */
+        uint32_t ticks() {
+            uint32_t count;
+            uint16_t ticks;
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                count = overflows;
+                ticks = R::counter();
+                count += pending(ticks);
+            }
+            return count * ticks_per_overflow + ticks;
+        }
+
+        /**
+        Microseconds since `start()`. Wraps after 71 minutes.
+        */
+        uint32_t micros() {
+            uint32_t count;
+            uint16_t ticks;
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                count = overflows;
+                ticks = R::counter();
+                count += pending(ticks);
+            }
+            return count * us_per_overflow + to_us(ticks);
+        }
+
+        /**
+        Milliseconds since `start()`. Wraps after 49 days.
+        */
+        uint32_t millis() {
+            uint32_t whole;
+            uint32_t part;
+            uint16_t ticks;
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                whole = ms;
+                part = us;
+                ticks = R::counter();
+                if ( pending(ticks) ) {
+                    whole += ms_per_overflow;
+                    part += us_remainder;
+                }
+            }
+            part += to_us(ticks);
+            while ( part >= 1000 ) {
+                part -= 1000;
+                ++whole;
+            }
+            return whole;
+        }
+};
+
+
 /**
 TIMER0: An 8-bit timer.
 
@@ -56,13 +742,335 @@ You can still use the two output compare channels, but you should leave
 the rest of the timer alone if you want Arduino code and libraries to work.
 */
 namespace timer0 {
+    /**
+    There are three possible interupts for timer0.
+    */
+    namespace interupts {
+        constexpr byte overflow     = (1 << TOIE0);
+        constexpr byte match_OCR0A  = (1 << OCIE0A);
+        constexpr byte match_OCR0B  = (1 << OCIE0B);
+    }
+
+    /**
+    Possible values for output on pin OC0A.
+
+    (ATMega328 pin PD6, or Arduino pin 6).
+
+    Exactly as `timer2::output_a`, see there for the details.
+    */
+    enum class output_a : byte {
+        disconnected    = 0x00,
+        toggle          = (1 << COM0A0),
+        non_inverting   = (1 << COM0A1),
+        inverting       = ((1 << COM0A0) | (1 << COM0A1)),
+    };
+
+    /**
+    Possible values for output on pin OC0B.
+
+    This is AVR pin PD5, or Arduino pin 5.
+    */
+    enum class output_b : byte {
+        disconnected    = 0x00,
+        toggle          = (1 << COM0B0),
+        non_inverting   = (1 << COM0B1),
+        inverting       = ((1 << COM0B0) | (1 << COM0B1)),
+    };
+
+
+    /**
+    Set timer0 to run in `Clear Timer on Compare (CTC)` mode.
+
+    ``OCR0A`` is the TOP, as `timer2::set_mode_ctc()`::
+
+        frequency = F_CPU / 2 * prescaler * (1 + OCR0A)
+    */
+    inline void set_mode_ctc() {
+        Timer<0>::set_mode<Waveform::ctc>();
+    }
+
+
+    /**
+    Set timer0 to run in 'Normal' mode, counting from 0 to 255 over and over.
+    */
+    inline void set_mode_normal() {
+        Timer<0>::set_mode<Waveform::normal>();
+    }
+
+
+    /**
+    Two independent PWM outputs at ``F_CPU / prescaler * 256``.
+
+    Duty-cycle for output A from ``OCR0A``, for output B from ``OCR0B``.
+    The mode used by Arduino's ``analogWrite()`` on pins 5 and 6.
+    */
+    inline void set_mode_pwm_fast() {
+        Timer<0>::set_mode<Waveform::pwm_fast>();
+    }
+
+
+    /**
+    Single PWM output on OC0B, with frequency set by ``OCR0A``.
+
+    As `timer2::set_mode_pwm_faster()`, including the one-shot trick.
+    */
+    inline void set_mode_pwm_faster() {
+        Timer<0>::set_mode<Waveform::pwm_faster>();
+    }
+
+
+    /**
+    Two glitch-free PWM outputs at half the frequency of `set_mode_pwm_fast()`.
+    */
+    inline void set_mode_pwm_phase_correct() {
+        Timer<0>::set_mode<Waveform::pwm_phase_correct>();
+    }
+
+
+    inline void use_outputs(output_a a, output_b b=output_b::disconnected) {
+        Timer<0>::use_outputs(
+            static_cast<Output>(static_cast<byte>(a) >> 6),
+            static_cast<Output>(static_cast<byte>(b) >> 4));
+    }
+
+
+    /**
+    Enable (or disable) interupt handlers.
+
+    See the values of `timer0::interupts`. Handlers are ``TIMER0_OVF_vect``,
+    ``TIMER0_COMPA_vect`` and ``TIMER0_COMPB_vect``. On an Arduino the overflow
+    handler is already taken.
+    */
+    inline void use_interupts(byte value) {
+        Timer<0>::use_interupts(value);
+    }
+
+
+    /**
+    Start the clock on timer0 and set its prescaler.
+    */
+    inline void use_prescaler(Clock prescaler) {
+        Timer<0>::use_prescaler(prescaler);
+    }
+
+
 } // namespace timer0
 
 
 /**
 TIMER1: A 16-bit timer.
+
+As timer0 and timer2 but with a 16-bit counter, so far finer control of
+frequency and duty-cycle: a 1Hz square wave, or 14-bit PWM at 1kHz from 16MHz.
+
+``TCNT1``, ``OCR1A``, ``OCR1B``, and ``ICR1`` are all 16-bit. The compiler
+takes care of the byte order needed to write them, but not atomicity: if an
+ISR also writes them, disable interupts around the write.
+
+The real prize is using ``ICR1`` as TOP. The frequency then becomes adjustable
+to within a few cycles, and both ``OCR1A`` and ``OCR1B`` still set
+independent duty-cycles, with up to 16 bits of resolution.
 */
 namespace timer1 {
+    /**
+    Prescaler values, the same as for timer0. External clock is on pin T1 (PD5).
+    */
+    using Clock = timer0::Clock;
+
+    /**
+    There are four possible interupts for timer1.
+    */
+    namespace interupts {
+        constexpr byte overflow         = (1 << TOIE1);
+        constexpr byte match_OCR1A      = (1 << OCIE1A);
+        constexpr byte match_OCR1B      = (1 << OCIE1B);
+        constexpr byte input_capture    = (1 << ICIE1);
+    }
+
+    /**
+    Possible values for output on pin OC1A.
+
+    (ATMega328 pin PB1, or Arduino pin 9).
+
+    As `timer2::output_a`. In the PWM modes `toggle` only works on OC1A, and
+    only in `set_mode_pwm_fast_icr()` or `set_mode_pwm_faster()` (or modes 9
+    and 11): a 50% square wave at half the PWM frequency.
+    */
+    enum class output_a : byte {
+        disconnected    = 0x00,
+        toggle          = (1 << COM1A0),
+        non_inverting   = (1 << COM1A1),
+        inverting       = ((1 << COM1A0) | (1 << COM1A1)),
+    };
+
+    /**
+    Possible values for output on pin OC1B.
+
+    This is AVR pin PB2, or Arduino pin 10.
+    */
+    enum class output_b : byte {
+        disconnected    = 0x00,
+        toggle          = (1 << COM1B0),
+        non_inverting   = (1 << COM1B1),
+        inverting       = ((1 << COM1B0) | (1 << COM1B1)),
+    };
+
+
+    /**
+    Set any of the sixteen waveform generation modes, by number.
+
+    The four ``WGM1n`` bits are split between ``TCCR1A`` and ``TCCR1B``. Modes
+    without a function of their own below are the 9 and 10-bit fixed-TOP PWM
+    modes (2, 3, 6 and 7), and phase and frequency correct with ``OCR1A`` as TOP
+    (9). See table 15-5 of the ATmega328P datasheet.
+
+    Args:
+        mode (byte): Zero to 15. Mode 13 is reserved.
+    */
+    inline void set_mode(byte mode) {
+        Timer<1>::set_wgm(mode);
+    }
+
+
+    /**
+    Set timer1 to run in 'Normal' mode, counting from 0 to 65535 over and over.
+
+    Best of the timers for timing events, up to 65535 ticks without overflow.
+    */
+    inline void set_mode_normal() {
+        Timer<1>::set_mode<Waveform::normal>();
+    }
+
+
+    /**
+    Set timer1 to run in CTC mode, with ``OCR1A`` as TOP.
+
+        frequency = F_CPU / 2 * prescaler * (1 + OCR1A)
+
+    From 16MHz with the prescaler at 256, ``OCR1A = 31249`` toggles OC1A at
+    exactly 1Hz.
+    */
+    inline void set_mode_ctc() {
+        Timer<1>::set_mode<Waveform::ctc>();
+    }
+
+
+    /**
+    Set timer1 to run in CTC mode, with ``ICR1`` as TOP.
+
+    As `set_mode_ctc()`, but leaves ``OCR1A`` and ``OCR1B`` free, eg. to fire
+    ``TIMER1_COMPA_vect`` part-way through each period. ``TIMER1_CAPT_vect``
+    fires at TOP.
+    */
+    inline void set_mode_ctc_icr() {
+        Timer<1>::set_mode<Waveform::ctc_icr>();
+    }
+
+
+    /**
+    Two 8-bit PWM outputs at ``F_CPU / prescaler * 256``, as timer0 and timer2.
+    */
+    inline void set_mode_pwm_fast() {
+        Timer<1>::set_mode<Waveform::pwm_fast>();
+    }
+
+
+    /**
+    Two 8-bit glitch-free PWM outputs at half the frequency of `set_mode_pwm_fast()`.
+    */
+    inline void set_mode_pwm_phase_correct() {
+        Timer<1>::set_mode<Waveform::pwm_phase_correct>();
+    }
+
+
+    /**
+    Two PWM outputs, of any frequency and resolution, with ``ICR1`` as TOP.
+
+        frequency = F_CPU / prescaler * (1 + ICR1)
+
+    Duty-cycles are set by ``OCR1A`` and ``OCR1B``, from 0 to ``ICR1``. For
+    example, 1kHz with 14 bits of resolution from a 16MHz clock::
+
+        set_mode_pwm_fast_icr();
+        ICR1 = 15999;           // 16MHz / 1 * (1 + 15999) = 1kHz
+        OCR1A = 4000;           // 25%
+        OCR1B = 12000;          // 75%
+        use_outputs(output_a::non_inverting, output_b::non_inverting);
+        use_prescaler(Clock::Divide_by_1);
+
+    ``ICR1`` is not double-buffered, so change it only while the counter is
+    stopped, or from the overflow ISR, or the counter may miss TOP and run
+    all the way round to 65535 once.
+    */
+    inline void set_mode_pwm_fast_icr() {
+        Timer<1>::set_mode<Waveform::pwm_fast_icr>();
+    }
+
+
+    /**
+    Single PWM output on OC1B, with ``OCR1A`` as TOP.
+
+    As `timer2::set_mode_pwm_faster()`. Use instead of `set_mode_pwm_fast_icr()`
+    when changing frequency on the fly: ``OCR1A`` is double-buffered.
+    */
+    inline void set_mode_pwm_faster() {
+        Timer<1>::set_mode<Waveform::pwm_faster>();
+    }
+
+
+    /**
+    Two glitch-free PWM outputs, of any frequency and resolution, ``ICR1`` as TOP.
+
+    Counts up to ``ICR1`` then back down, so half the frequency of
+    `set_mode_pwm_fast_icr()`::
+
+        frequency = F_CPU / 2 * prescaler * ICR1
+
+    Use for motors, or where the pulse centres must stay aligned.
+    */
+    inline void set_mode_pwm_phase_correct_icr() {
+        Timer<1>::set_mode<Waveform::pwm_phase_correct_icr>();
+    }
+
+
+    /**
+    As `set_mode_pwm_phase_correct_icr()`, but updates only at BOTTOM.
+
+    Frequency changes then never give a lopsided period, so this is the mode to
+    use when sweeping ``ICR1``, eg. for audio or stepper motor ramps.
+    */
+    inline void set_mode_pwm_phase_frequency_correct_icr() {
+        Timer<1>::set_mode<Waveform::pwm_phase_frequency_correct_icr>();
+    }
+
+
+    inline void use_outputs(output_a a, output_b b=output_b::disconnected) {
+        Timer<1>::use_outputs(
+            static_cast<Output>(static_cast<byte>(a) >> 6),
+            static_cast<Output>(static_cast<byte>(b) >> 4));
+    }
+
+
+    /**
+    Enable (or disable) interupt handlers.
+
+    See the values of `timer1::interupts`. Handlers are ``TIMER1_OVF_vect``,
+    ``TIMER1_COMPA_vect``, ``TIMER1_COMPB_vect``, and ``TIMER1_CAPT_vect``. The
+    last fires on input capture, or at TOP in `set_mode_ctc_icr()`.
+    */
+    inline void use_interupts(byte value) {
+        Timer<1>::use_interupts(value);
+    }
+
+
+    /**
+    Start the clock on timer1 and set its prescaler.
+    */
+    inline void use_prescaler(Clock prescaler) {
+        Timer<1>::use_prescaler(prescaler);
+    }
+
+
 } // namespace timer1
 
 
@@ -169,10 +1177,8 @@ namespace timer2 {
         }
 
     */
-    void set_mode_ctc() {
-        TCCR2A &= ~(1 << WGM20);
-        TCCR2A |= (1 << WGM21);
-        TCCR2B &= ~(1 << WGM22);
+    inline void set_mode_ctc() {
+        Timer<2>::set_mode<Waveform::ctc>();
     }
 
 
@@ -205,9 +1211,8 @@ namespace timer2 {
         OCR2A = 0;
         OCR2B = 127;
     */
-    void set_mode_normal() {
-        TCCR2A &= ~((1 << WGM20) | (1 << WGM21));
-        TCCR2B &= ~(1 << WGM22);
+    inline void set_mode_normal() {
+        Timer<2>::set_mode<Waveform::normal>();
     }
 
 
@@ -227,9 +1232,8 @@ namespace timer2 {
         OCR2B = 255;
 
     */
-    void set_mode_pwm_fast() {
-        TCCR2A |= ((1 << WGM20) | (1 << WGM21));
-        TCCR2B &= ~(1 << WGM22);
+    inline void set_mode_pwm_fast() {
+        Timer<2>::set_mode<Waveform::pwm_fast>();
     }
 
 
@@ -277,9 +1281,8 @@ namespace timer2 {
     Credit for the technique goes to:
     https://wp.josh.com/2015/03/12/avr-timer-based-one-shot-explained/
     */
-    void set_mode_pwm_faster() {
-        TCCR2A |= ((1 << WGM20) | (1 << WGM21));
-        TCCR2B |= (1 << WGM22);
+    inline void set_mode_pwm_faster() {
+        Timer<2>::set_mode<Waveform::pwm_faster>();
     }
 
 
@@ -300,18 +1303,15 @@ namespace timer2 {
         OCR2B = 255
 
     */
-    void set_mode_pwm_phase_correct() {
-        TCCR2A |= (1 << WGM20);
-        TCCR2A &= ~(1 << WGM21);
-        TCCR2B &= ~(1 << WGM22);
+    inline void set_mode_pwm_phase_correct() {
+        Timer<2>::set_mode<Waveform::pwm_phase_correct>();
     }
 
 
-    void use_outputs(output_a a, output_b b=output_b::disconnected) {
-        TCCR2A &= ~((1 << COM2A0) | (1 << COM2A1));
-        TCCR2A |= static_cast<byte>(a);
-        TCCR2A &= ~((1 << COM2B0) | (1 << COM2B1));
-        TCCR2A |= static_cast<byte>(b);
+    inline void use_outputs(output_a a, output_b b=output_b::disconnected) {
+        Timer<2>::use_outputs(
+            static_cast<Output>(static_cast<byte>(a) >> 6),
+            static_cast<Output>(static_cast<byte>(b) >> 4));
     }
 
     /**
@@ -341,18 +1341,16 @@ namespace timer2 {
                 use_interupts(interupts::overflow | interupts::match_OCR2A)
 
     */
-    void use_interupts(byte value) {
-        TIMSK2 &= ~((1 << TOIE2) | (1 << OCIE2A) | (1 << OCIE2B));
-        TIMSK2 |= value;
+    inline void use_interupts(byte value) {
+        Timer<2>::use_interupts(value);
     }
 
 
     /**
     Start the clock on timer2 and set its prescaler.
     */
-    void use_prescaler(Clock prescaler) {
-        TCCR2B &= ~( (1 << CS20) | (1 << CS21) | (1 << CS22) );
-        TCCR2B |= static_cast<byte>(prescaler);
+    inline void use_prescaler(Clock prescaler) {
+        Timer<2>::use_prescaler(prescaler);
     }
 
 